@@ -0,0 +1,361 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// principal axis of the block through power iteration on the covariance matrix.
+// Endpoints are the pixels projected furthest apart along it
+static void FindEndpoints(const unsigned char* pixels, int channels, float* minEndpoint, float* maxEndpoint)
+{
+	float mean[4] = {};
+
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			mean[c] += pixels[i * 4 + c] / 16.0f;
+		}
+	}
+
+	float covariance[4][4] = {};
+
+	for (int i = 0; i < 16; i++)
+	{
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = 0; b < channels; b++)
+			{
+				covariance[a][b] += (pixels[i * 4 + a] - mean[a]) * (pixels[i * 4 + b] - mean[b]);
+			}
+		}
+	}
+
+	float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {};
+		float length = 0.0f;
+
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = 0; b < channels; b++)
+			{
+				next[a] += covariance[a][b] * axis[b];
+			}
+
+			length = std::max(length, std::fabs(next[a]));
+		}
+
+		// flat block - any axis works
+		if (length < 1e-6f)
+		{
+			break;
+		}
+
+		for (int c = 0; c < channels; c++)
+		{
+			axis[c] = next[c] / length;
+		}
+	}
+
+	float minProjection = 1e30f;
+	float maxProjection = -1e30f;
+
+	for (int i = 0; i < 16; i++)
+	{
+		float projection = 0.0f;
+
+		for (int c = 0; c < channels; c++)
+		{
+			projection += (pixels[i * 4 + c] - mean[c]) * axis[c];
+		}
+
+		minProjection = std::min(minProjection, projection);
+		maxProjection = std::max(maxProjection, projection);
+	}
+
+	float axisLengthSquared = 0.0f;
+
+	for (int c = 0; c < channels; c++)
+	{
+		axisLengthSquared += axis[c] * axis[c];
+	}
+
+	for (int c = 0; c < channels; c++)
+	{
+		const float scale = axis[c] / axisLengthSquared;
+		minEndpoint[c] = std::min(255.0f, std::max(0.0f, mean[c] + minProjection * scale));
+		maxEndpoint[c] = std::min(255.0f, std::max(0.0f, mean[c] + maxProjection * scale));
+	}
+}
+
+static int Distance(const unsigned char* pixel, const int* colour, int channels)
+{
+	int distance = 0;
+
+	for (int c = 0; c < channels; c++)
+	{
+		const int difference = pixel[c] - colour[c];
+		distance += difference * difference;
+	}
+
+	return distance;
+}
+
+static uint16_t ToRGB565(const float* colour)
+{
+	const int r = (int)(colour[0] * 31.0f / 255.0f + 0.5f);
+	const int g = (int)(colour[1] * 63.0f / 255.0f + 0.5f);
+	const int b = (int)(colour[2] * 31.0f / 255.0f + 0.5f);
+
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void FromRGB565(uint16_t packed, int* colour)
+{
+	const int r = (packed >> 11) & 31;
+	const int g = (packed >> 5) & 63;
+	const int b = packed & 31;
+
+	colour[0] = (r << 3) | (r >> 2);
+	colour[1] = (g << 2) | (g >> 4);
+	colour[2] = (b << 3) | (b >> 2);
+}
+
+void CompressBlockBC1(const unsigned char* pixels, unsigned char* block)
+{
+	float minEndpoint[4];
+	float maxEndpoint[4];
+	FindEndpoints(pixels, 3, minEndpoint, maxEndpoint);
+
+	uint16_t colour0 = ToRGB565(maxEndpoint);
+	uint16_t colour1 = ToRGB565(minEndpoint);
+
+	// colour0 > colour1 selects the four colour mode, equal endpoints use index 0 everywhere
+	if (colour0 < colour1)
+	{
+		std::swap(colour0, colour1);
+	}
+
+	uint32_t indices = 0;
+
+	if (colour0 != colour1)
+	{
+		int palette[4][3];
+		FromRGB565(colour0, palette[0]);
+		FromRGB565(colour1, palette[1]);
+
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0;
+			int bestDistance = Distance(pixels + i * 4, palette[0], 3);
+
+			for (int p = 1; p < 4; p++)
+			{
+				const int distance = Distance(pixels + i * 4, palette[p], 3);
+
+				if (distance < bestDistance)
+				{
+					best = p;
+					bestDistance = distance;
+				}
+			}
+
+			indices |= (uint32_t)best << (i * 2);
+		}
+	}
+
+	block[0] = colour0 & 0xFF;
+	block[1] = colour0 >> 8;
+	block[2] = colour1 & 0xFF;
+	block[3] = colour1 >> 8;
+	std::memcpy(block + 4, &indices, sizeof(indices));
+}
+
+void CompressBlockBC3(const unsigned char* pixels, unsigned char* block)
+{
+	int alpha0 = 0;
+	int alpha1 = 255;
+
+	for (int i = 0; i < 16; i++)
+	{
+		alpha0 = std::max(alpha0, (int)pixels[i * 4 + 3]);
+		alpha1 = std::min(alpha1, (int)pixels[i * 4 + 3]);
+	}
+
+	// alpha0 > alpha1 selects eight interpolated values
+	uint64_t indices = 0;
+
+	if (alpha0 != alpha1)
+	{
+		int palette[8] = { alpha0, alpha1 };
+
+		for (int p = 1; p < 7; p++)
+		{
+			palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0;
+
+			for (int p = 1; p < 8; p++)
+			{
+				if (std::abs(pixels[i * 4 + 3] - palette[p]) < std::abs(pixels[i * 4 + 3] - palette[best]))
+				{
+					best = p;
+				}
+			}
+
+			indices |= (uint64_t)best << (i * 3);
+		}
+	}
+
+	block[0] = (unsigned char)alpha0;
+	block[1] = (unsigned char)alpha1;
+
+	for (int i = 0; i < 6; i++)
+	{
+		block[2 + i] = (unsigned char)(indices >> (i * 8));
+	}
+
+	CompressBlockBC1(pixels, block + 8);
+}
+
+// appends bits to a 128 bit block, least significant bit first
+class BlockWriter
+{
+public:
+	explicit BlockWriter(unsigned char* block) : _block(block)
+	{
+		std::memset(_block, 0, 16);
+	}
+
+	void Write(uint32_t value, int bitCount)
+	{
+		for (int i = 0; i < bitCount; i++, _position++)
+		{
+			_block[_position / 8] |= ((value >> i) & 1) << (_position % 8);
+		}
+	}
+
+private:
+	unsigned char* _block;
+	int _position = 0;
+};
+
+static const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// picks the 7 bit endpoint and the shared p-bit that reproduce the endpoint best
+static void QuantizeBC7Endpoint(const float* endpoint, int* quantized, int& pBit)
+{
+	float bestError = 1e30f;
+
+	for (int p = 0; p < 2; p++)
+	{
+		int candidate[4];
+		float error = 0.0f;
+
+		for (int c = 0; c < 4; c++)
+		{
+			candidate[c] = std::min(127, std::max(0, (int)std::floor((endpoint[c] - p) / 2.0f + 0.5f)));
+
+			const float difference = endpoint[c] - (float)((candidate[c] << 1) | p);
+			error += difference * difference;
+		}
+
+		if (error < bestError)
+		{
+			bestError = error;
+			pBit = p;
+			std::memcpy(quantized, candidate, sizeof(candidate));
+		}
+	}
+}
+
+void CompressBlockBC7(const unsigned char* pixels, unsigned char* block)
+{
+	float minEndpoint[4];
+	float maxEndpoint[4];
+	FindEndpoints(pixels, 4, minEndpoint, maxEndpoint);
+
+	int endpoints[2][4];
+	int pBits[2];
+	QuantizeBC7Endpoint(minEndpoint, endpoints[0], pBits[0]);
+	QuantizeBC7Endpoint(maxEndpoint, endpoints[1], pBits[1]);
+
+	int palette[16][4];
+
+	for (int c = 0; c < 4; c++)
+	{
+		const int e0 = (endpoints[0][c] << 1) | pBits[0];
+		const int e1 = (endpoints[1][c] << 1) | pBits[1];
+
+		for (int p = 0; p < 16; p++)
+		{
+			palette[p][c] = ((64 - BC7_WEIGHTS4[p]) * e0 + BC7_WEIGHTS4[p] * e1 + 32) >> 6;
+		}
+	}
+
+	int indices[16];
+
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0;
+		int bestDistance = Distance(pixels + i * 4, palette[0], 4);
+
+		for (int p = 1; p < 16; p++)
+		{
+			const int distance = Distance(pixels + i * 4, palette[p], 4);
+
+			if (distance < bestDistance)
+			{
+				best = p;
+				bestDistance = distance;
+			}
+		}
+
+		indices[i] = best;
+	}
+
+	// the first index is stored with 3 bits, its top bit must be zero - swap the endpoints if it is not
+	if (indices[0] & 8)
+	{
+		std::swap(endpoints[0], endpoints[1]);
+		std::swap(pBits[0], pBits[1]);
+
+		for (int& index : indices)
+		{
+			index = 15 - index;
+		}
+	}
+
+	BlockWriter writer(block);
+
+	// mode 6 is encoded as six zero bits followed by a one
+	writer.Write(1 << 6, 7);
+
+	for (int c = 0; c < 4; c++)
+	{
+		writer.Write(endpoints[0][c], 7);
+		writer.Write(endpoints[1][c], 7);
+	}
+
+	writer.Write(pBits[0], 1);
+	writer.Write(pBits[1], 1);
+
+	writer.Write(indices[0], 3);
+
+	for (int i = 1; i < 16; i++)
+	{
+		writer.Write(indices[i], 4);
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Encoders for one 4x4 block of RGBA8 pixels (64 bytes, row by row)
+
+// 8 bytes, two RGB565 endpoints and 2-bit indices. Alpha is ignored
+void CompressBlockBC1(const unsigned char* pixels, unsigned char* block);
+
+// 16 bytes, a BC4 style alpha block followed by a BC1 colour block
+void CompressBlockBC3(const unsigned char* pixels, unsigned char* block);
+
+// 16 bytes, BC7 mode 6 only - one RGBA subset with 7 bit endpoints plus p-bit and 4-bit indices
+void CompressBlockBC7(const unsigned char* pixels, unsigned char* block);
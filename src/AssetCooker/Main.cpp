@@ -0,0 +1,74 @@
+#include <cstring>
+#include <iostream>
+
+#include "MeshCooker.h"
+#include "TextureCooker.h"
+
+static bool ParseTextureFormat(const char* option, TextureFormat& format)
+{
+	const struct { const char* option; TextureFormat format; } formats[] =
+	{
+		{ "--bc1", TextureFormat::BC1 },
+		{ "--bc3", TextureFormat::BC3 },
+		{ "--bc7", TextureFormat::BC7 },
+		{ "--rgba8", TextureFormat::RGBA8 }
+	};
+
+	for (const auto& entry : formats)
+	{
+		if (std::strcmp(option, entry.option) == 0)
+		{
+			format = entry.format;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Offline asset processing, run as a pre-build step of the game:
+//   AssetCooker mesh <model.obj>...
+//   AssetCooker texture [--bc1|--bc3|--bc7|--rgba8] <image.png>...
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cout << "usage: AssetCooker mesh <model.obj>...\n"
+			<< "       AssetCooker texture [--bc1|--bc3|--bc7|--rgba8] <image.png>..." << std::endl;
+		return 1;
+	}
+
+	bool success = true;
+
+	if (std::strcmp(argv[1], "mesh") == 0)
+	{
+		for (int i = 2; i < argc; i++)
+		{
+			success &= CookMesh(argv[i]);
+		}
+	}
+	else if (std::strcmp(argv[1], "texture") == 0)
+	{
+		// BC1 for opaque images and BC3 for the rest unless a format is forced
+		TextureFormat format = TextureFormat::BC1;
+		bool autoFormat = true;
+
+		for (int i = 2; i < argc; i++)
+		{
+			if (ParseTextureFormat(argv[i], format))
+			{
+				autoFormat = false;
+				continue;
+			}
+
+			success &= CookTexture(argv[i], format, autoFormat);
+		}
+	}
+	else
+	{
+		std::cout << "unknown asset type " << argv[1] << std::endl;
+		return 1;
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#include "MeshCooker.h"
+
+#include <iomanip>
+#include <iostream>
+
+#include "models/MeshFile.h"
+#include "models/MeshOptimizer.h"
+#include "models/Model.h"
+
+bool CookMesh(const std::string& path)
+{
+	Model model;
+	model.loadASSIMP(path);
+
+	if (model.vertices.empty() || model.indices.empty())
+	{
+		std::cout << "ERROR::MESH_COOKER::IMPORT_FAILED " << path << std::endl;
+		return false;
+	}
+
+	const size_t verticesBefore = model.vertices.size();
+	const float acmrBefore = ComputeACMR(model.indices, model.vertices.size());
+
+	WeldVertices(model.vertices, model.indices);
+	OptimizeVertexCache(model.indices, model.vertices.size());
+	OptimizeOverdraw(model.indices, model.vertices);
+	OptimizeVertexFetch(model.vertices, model.indices);
+
+	const float acmrAfter = ComputeACMR(model.indices, model.vertices.size());
+
+	const std::string outputPath = path.substr(0, path.find_last_of('.')) + ".mesh";
+
+	std::vector<PackedVertex> packedVertices;
+	packedVertices.reserve(model.vertices.size());
+
+	for (const auto& vertex : model.vertices)
+	{
+		packedVertices.push_back(PackVertex(vertex));
+	}
+
+	if (!WriteMeshFile(outputPath, packedVertices, model.indices))
+	{
+		std::cout << "ERROR::MESH_COOKER::WRITE_FAILED " << outputPath << std::endl;
+		return false;
+	}
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< path << "\n"
+		<< "  triangles: " << model.indices.size() / 3 << "\n"
+		<< "  vertices:  " << verticesBefore << " -> " << model.vertices.size() << "\n"
+		<< "  ACMR:      " << acmrBefore << " -> " << acmrAfter << "\n"
+		<< "  indices:   " << (model.vertices.size() <= 0xFFFF ? 16 : 32) << "-bit\n"
+		<< "  vertex:    " << sizeof(Vertex) << " -> " << sizeof(PackedVertex) << " bytes\n";
+
+	return true;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// Imports a model through Assimp, welds duplicate vertices, optimizes the triangle order for the
+// post-transform vertex cache and overdraw, and writes a .mesh file next to the source model
+bool CookMesh(const std::string& path);
@@ -0,0 +1,125 @@
+#include "TextureCooker.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image/stb_image.h>
+
+#include "BlockCompression.h"
+
+static TextureLevel Compress(const TextureLevel& source, TextureFormat format)
+{
+	if (format == TextureFormat::RGBA8)
+	{
+		return source;
+	}
+
+	TextureLevel level;
+	level.width = source.width;
+	level.height = source.height;
+	level.data.resize(GetTextureLevelSize(format, source.width, source.height));
+
+	const size_t blockBytes = format == TextureFormat::BC1 ? 8 : 16;
+	unsigned char* block = level.data.data();
+
+	for (uint32_t by = 0; by < source.height; by += 4)
+	{
+		for (uint32_t bx = 0; bx < source.width; bx += 4)
+		{
+			// blocks hanging over the edge repeat the last row and column
+			unsigned char pixels[64];
+
+			for (uint32_t y = 0; y < 4; y++)
+			{
+				for (uint32_t x = 0; x < 4; x++)
+				{
+					const uint32_t sx = std::min(bx + x, source.width - 1);
+					const uint32_t sy = std::min(by + y, source.height - 1);
+
+					std::copy_n(&source.data[((size_t)sy * source.width + sx) * 4], 4, &pixels[(y * 4 + x) * 4]);
+				}
+			}
+
+			switch (format)
+			{
+				case TextureFormat::BC1: CompressBlockBC1(pixels, block); break;
+				case TextureFormat::BC3: CompressBlockBC3(pixels, block); break;
+				default: CompressBlockBC7(pixels, block); break;
+			}
+
+			block += blockBytes;
+		}
+	}
+
+	return level;
+}
+
+bool CookTexture(const std::string& path, TextureFormat format, bool autoFormat)
+{
+	int width;
+	int height;
+	int channels;
+	unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+
+	if (!data)
+	{
+		std::cout << "ERROR::TEXTURE_COOKER::IMPORT_FAILED " << path << std::endl;
+		return false;
+	}
+
+	TextureLevel image;
+	image.width = width;
+	image.height = height;
+	image.data.assign(data, data + (size_t)width * height * 4);
+
+	stbi_image_free(data);
+
+	if (autoFormat)
+	{
+		bool opaque = true;
+
+		for (size_t i = 3; i < image.data.size(); i += 4)
+		{
+			opaque &= image.data[i] == 255;
+		}
+
+		format = opaque ? TextureFormat::BC1 : TextureFormat::BC3;
+	}
+
+	std::vector<TextureLevel> levels;
+	size_t compressedBytes = 0;
+
+	while (true)
+	{
+		levels.push_back(Compress(image, format));
+		compressedBytes += levels.back().data.size();
+
+		if (image.width == 1 && image.height == 1)
+		{
+			break;
+		}
+
+		image = DownsampleTextureLevel(image, 4);
+	}
+
+	const std::string outputPath = path.substr(0, path.find_last_of('.')) + ".ktx2";
+
+	if (!WriteKtx2File(outputPath, format, levels))
+	{
+		std::cout << "ERROR::TEXTURE_COOKER::WRITE_FAILED " << outputPath << std::endl;
+		return false;
+	}
+
+	// what the PNG path used to upload, RGBA8 plus the generated mips
+	const size_t uncompressedBytes = (size_t)width * height * 4 * 4 / 3;
+
+	std::cout << std::fixed << std::setprecision(1)
+		<< path << "\n"
+		<< "  size:   " << width << "x" << height << ", " << levels.size() << " mips\n"
+		<< "  format: " << GetTextureFormatName(format) << "\n"
+		<< "  VRAM:   " << uncompressedBytes / 1024.0f << " KB -> " << compressedBytes / 1024.0f << " KB\n";
+
+	return true;
+}
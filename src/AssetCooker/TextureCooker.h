@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+
+#include "TextureFile.h"
+
+// Decodes an image through stb_image, builds the full mip chain, block-compresses every level and
+// writes a .ktx2 file next to the source image. With autoFormat set, BC1 is used for opaque images and BC3 otherwise
+bool CookTexture(const std::string& path, TextureFormat format, bool autoFormat);
@@ -1,6 +1,17 @@
 #include "Application.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,8 +21,14 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Camera.h"
+#include "Framebuffer.h"
+#include "Frustum.h"
+#include "GLCallCounter.h"
+#include "PngWriter.h"
+#include "RenderState.h"
 #include "Settings.h"
 #include "Shader.h"
+#include "TransformBatch.h"
 
 #include "models/Ball.h"
 #include "models/Brick.h"
@@ -55,9 +72,6 @@ const unsigned numbBricksWide = 10;
 const unsigned boundBlocks = 20;
 const unsigned topBlocks = 25;
 std::unique_ptr<Brick> bricks[numbBricksHigh][numbBricksWide];
-std::unique_ptr<Brick> boundLeft[boundBlocks];
-std::unique_ptr<Brick> boundRight[boundBlocks];
-std::unique_ptr<Brick> boundTop[topBlocks];
 
 // game objects
 std::vector<std::unique_ptr<Texture>> scoreText;
@@ -68,7 +82,160 @@ glm::mat4 orthoProgMatrix;
 glm::mat4 orthoViewMatrix;
 glm::mat4 modelTranslate;
 glm::mat4 modelScale;
-glm::mat4 modelRotation;
+glm::mat4 viewMatrix;
+glm::mat4 projectionMatrix;
+
+// 3D objects of the level, set each frame on the GL thread
+// one array per field, so ComposeTransforms builds the transforms of four objects at a time
+struct SceneObjects
+{
+	std::vector<Model*> models;
+	std::vector<Texture*> textures;
+	std::vector<glm::vec3> colours;
+
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> positionZ;
+	std::vector<float> rotations;
+	std::vector<float> scaleX;
+	std::vector<float> scaleY;
+	std::vector<float> scaleZ;
+
+	// entries changed since the last PrepareDrawItems, only these get a new transform, bounds and upload
+	std::vector<unsigned char> dirty;
+
+	unsigned GetCount() const { return (unsigned)models.size(); }
+
+	// entries are matched up by the order they are set in, every frame starts again at the first
+	void Begin()
+	{
+		_next = 0;
+	}
+
+	// drops the entries that were not set this frame
+	void End()
+	{
+		if (_next < GetCount())
+		{
+			Resize(_next);
+		}
+	}
+
+	void Set(Model& model, glm::vec3 position, glm::vec3 scale, float rotation, glm::vec3 colour, Texture& texture)
+	{
+		const unsigned i = _next++;
+
+		if (i == GetCount())
+		{
+			Resize(i + 1);
+		}
+		else if (models[i] == &model && textures[i] == &texture && colours[i] == colour && rotations[i] == rotation
+			&& positionX[i] == position.x && positionY[i] == position.y && positionZ[i] == position.z
+			&& scaleX[i] == scale.x && scaleY[i] == scale.y && scaleZ[i] == scale.z)
+		{
+			return;
+		}
+
+		models[i] = &model;
+		textures[i] = &texture;
+		colours[i] = colour;
+		positionX[i] = position.x;
+		positionY[i] = position.y;
+		positionZ[i] = position.z;
+		rotations[i] = rotation;
+		scaleX[i] = scale.x;
+		scaleY[i] = scale.y;
+		scaleZ[i] = scale.z;
+		dirty[i] = 1;
+	}
+
+	// for changes the table can't see, like a model that finished loading
+	void MarkAllDirty()
+	{
+		std::fill(dirty.begin(), dirty.end(), (unsigned char)1);
+	}
+
+	void ClearDirty()
+	{
+		std::fill(dirty.begin(), dirty.end(), (unsigned char)0);
+	}
+
+private:
+	void Resize(unsigned count)
+	{
+		models.resize(count);
+		textures.resize(count);
+		colours.resize(count);
+		positionX.resize(count);
+		positionY.resize(count);
+		positionZ.resize(count);
+		rotations.resize(count);
+		scaleX.resize(count);
+		scaleY.resize(count);
+		scaleZ.resize(count);
+		dirty.resize(count, 1);
+	}
+
+	unsigned _next = 0;
+};
+
+SceneObjects sceneObjects;
+
+// what the GL thread needs to draw a scene object besides its ModelInstance, prepared by a job and tested against the view frustum
+struct DrawItem
+{
+	Model* model;
+	Texture* texture;
+	unsigned lod;
+
+	// squared distance from the camera to the bounds center, opaque items are drawn nearest first
+	float distance;
+};
+
+// scene objects per preparation job
+const unsigned prepareChunkSize = 64;
+
+// size of the instance buffer, objects past it are not drawn
+const unsigned maxSceneObjects = 16384;
+
+// transform and colour of every draw item, built by the preparation jobs when their object changed
+std::vector<ModelInstance> modelInstances;
+
+// the camera and table size the draw items were last prepared for, when they change every item's
+// level of detail, distance and visibility is prepared again
+glm::mat4 preparedViewProjection;
+unsigned preparedCount = 0;
+int preparedScreenHeight = 0;
+
+// short lived light where a brick was destroyed
+struct ExplosionLight
+{
+	glm::vec3 position;
+	glm::vec3 colour;
+	float age;
+};
+
+const float explosionLightLifetime = 0.6f;
+std::vector<ExplosionLight> explosionLights;
+
+// drives the --lights orbits
+float extraLightTime = 0.0f;
+
+Frustum frustum;
+std::vector<DrawItem> drawItems;
+
+// world space bounding spheres of the draw items, one array per component for batched culling
+std::vector<float> boundsX;
+std::vector<float> boundsY;
+std::vector<float> boundsZ;
+std::vector<float> boundsRadius;
+std::vector<unsigned char> visibleItems;
+
+// indices of the visible draw items, front to back
+std::vector<unsigned> drawOrder;
+
+// the visible items of every preparation job, sorted by the job and merged into drawOrder
+std::vector<std::vector<unsigned>> chunkOrders;
 
 bool gameWon;
 
@@ -90,6 +257,16 @@ void Application::ProcessInput(GLFWwindow* window)
 		state = GameState::Exit;
 		glfwSetWindowShouldClose(window, true);
 	}
+
+	// toggle the frame time graph on the key press, not every frame it is held
+	const bool statsKey = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+
+	if (statsKey && !_frameStatsKeyDown)
+	{
+		_showFrameStats = !_showFrameStats;
+	}
+
+	_frameStatsKeyDown = statsKey;
 }
 
 void Application::ProcessCameras(GLFWwindow* window)
@@ -160,12 +337,33 @@ void Application::ProcessCameras(GLFWwindow* window)
 	}
 }
 
-void Application::Run()
+void Application::Run(const LaunchOptions& options)
 {
+	_options = options;
+
 	// glfw: initialize and configure
 	if (!glfwInit())
 		return;
 
+	// headless runs draw into a framebuffer, the hidden window only carries the context.
+	// The shaders are GLSL 4.50, so 4.5 core is enough, which is also what llvmpipe exposes
+	if (options.headless)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+		if (options.headlessContext == HeadlessContext::EGL)
+		{
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+		}
+		else if (options.headlessContext == HeadlessContext::OSMesa)
+		{
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+		}
+	}
+
 	// glfw window creation
 	GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, WINDOW_TITLE, NULL, NULL);
 	
@@ -185,6 +383,16 @@ void Application::Run()
 		return;
 	}
 
+	// draw, bind and uniform counts per frame, live in the title of debug builds and in benchmark.csv
+#ifdef _DEBUG
+	InstallGLCallCounters();
+#endif
+
+	if (options.headless)
+	{
+		InstallGLCallCounters();
+	}
+
 	glViewport(0, 0, screenWidth, screenHeight);
 
 	glfwSetWindowUserPointer(window, this);
@@ -192,13 +400,87 @@ void Application::Run()
 
 	Init();
 
+	if (options.lodReport)
+	{
+		_assetLoader->Finish();
+		ReportLods();
+		Shutdown();
+		glfwTerminate();
+		return;
+	}
+
+	if (!options.profileTrace.empty())
+	{
+		_profiler = std::make_unique<GpuProfiler>();
+	}
+
+	if (options.headless)
+	{
+		RunBenchmark(window);
+		WriteProfile();
+		Shutdown();
+		glfwTerminate();
+		return;
+	}
+
+	float titleTimer = 0.0f;
+
 	while (!glfwWindowShouldClose(window))
 	{
+		const auto frameStart = std::chrono::steady_clock::now();
+		FrameTimes times;
+
 		// per-frame time logic
 		const float currentFrame = glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
+		// show how many objects the frustum culling saved once per second
+		titleTimer += deltaTime;
+
+		if (titleTimer >= 1.0f)
+		{
+			titleTimer = 0.0f;
+
+			std::string title = std::string(WINDOW_TITLE) + " | drawn: " + std::to_string(_drawnObjects) + " culled: " + std::to_string(_culledObjects);
+
+			if (_assetLoader->GetPending() > 0)
+			{
+				title += " | loading: " + std::to_string(_assetLoader->GetPending());
+			}
+
+			const FrameStats::Summary summary = _frameStats.Summarize();
+
+			std::ostringstream stats;
+			stats << std::fixed << std::setprecision(1) << " | frame ms p50 " << summary.p50 << " p95 " << summary.p95
+				<< " p99 " << summary.p99 << " max " << summary.max << " | hitches " << summary.hitches;
+
+			title += stats.str();
+
+			if (AreGLCallCountersInstalled())
+			{
+				title += " | draws " + std::to_string(_glCalls.drawCalls) + " vertices " + std::to_string(_glCalls.vertices)
+					+ " binds " + std::to_string(_glCalls.GetBinds()) + " (" + std::to_string(_glCalls.redundantBinds) + " redundant)"
+					+ " uniforms " + std::to_string(_glCalls.uniformUploads);
+			}
+
+			glfwSetWindowTitle(window, title.c_str());
+		}
+
+		if (_profiler)
+		{
+			_profiler->BeginFrame();
+		}
+
+		// hand finished assets to GL, objects without their model yet are skipped when drawn.
+		// A model that arrived brings its bounds and levels of detail, so every draw item is prepared again
+		const unsigned pending = _assetLoader->GetPending();
+
+		if (_assetLoader->Update() != pending)
+		{
+			sceneObjects.MarkAllDirty();
+		}
+
 		// handle input
 		ProcessInput(window);
 
@@ -206,22 +488,370 @@ void Application::Run()
 		ProcessCameras(window);
 
 		// handle updating
-		Update(window, deltaTime);
+		{
+			ProfileScope scope(_profiler.get(), "Update");
+			Update(window, deltaTime);
+		}
+
+		const auto renderStart = std::chrono::steady_clock::now();
 
 		// handle rendering
 		Render();
 
+		if (_showFrameStats)
+		{
+			RenderFrameStats();
+		}
+
+		const auto swapStart = std::chrono::steady_clock::now();
+
 		glfwSwapBuffers(window);
 		glfwPollEvents();
+
+		const auto frameEnd = std::chrono::steady_clock::now();
+
+		times.update = std::chrono::duration<float, std::milli>(renderStart - frameStart).count();
+		times.render = std::chrono::duration<float, std::milli>(swapStart - renderStart).count();
+		times.swap = std::chrono::duration<float, std::milli>(frameEnd - swapStart).count();
+		times.total = std::chrono::duration<float, std::milli>(frameEnd - frameStart).count();
+
+		_frameStats.Add(times);
+		_glCalls = TakeGLCallCounts();
 	}
 
+	const FrameStats::Summary summary = _frameStats.Summarize();
+	std::cout << "FRAME_STATS::TOTAL p50 " << summary.p50 << " ms, p95 " << summary.p95 << " ms, p99 " << summary.p99
+		<< " ms, max " << summary.max << " ms, hitches " << _frameStats.GetTotalHitches() << std::endl;
+
+	_frameStats.WriteCsv("frame_stats.csv");
+
+	WriteProfile();
+
+	Shutdown();
 	glfwTerminate();
 }
 
+void Application::Shutdown()
+{
+	// the loader first, its workers may still hold models
+	_assetLoader.reset();
+	_profiler.reset();
+
+	for (auto& row : bricks)
+	{
+		for (auto& brick : row)
+		{
+			brick.reset();
+		}
+	}
+
+	scoreObject.clear();
+	scoreText.clear();
+
+	_skybox.reset();
+	_player.reset();
+	_lives.reset();
+	_win.reset();
+	_gameover.reset();
+	_ball.reset();
+	_brick.reset();
+	_wallLeft.reset();
+	_wallRight.reset();
+	_wallTop.reset();
+	_statsBar.reset();
+
+	_ballImpostors.reset();
+	_tiledLighting.reset();
+	_particles.reset();
+
+	Model::instanceBuffer = nullptr;
+	_modelInstances.reset();
+
+	// the scene table and draw items only point at what was just released
+	sceneObjects.Begin();
+	sceneObjects.End();
+	drawItems.clear();
+	drawOrder.clear();
+
+	_shader.reset();
+	_spriteShader.reset();
+	_impostorShader.reset();
+	_skyboxShader.reset();
+	_depthShader.reset();
+	_lightCullingShader.reset();
+	_particleShader.reset();
+	_particleUpdateShader.reset();
+	_particleEmitShader.reset();
+}
+
+void Application::RunBenchmark(GLFWwindow* window)
+{
+	const unsigned frames = _options.benchmarkFrames;
+
+	std::cout << "BENCHMARK::RENDERER " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+
+	// every run starts from the same fully loaded scene
+	_assetLoader->Finish();
+
+	Framebuffer target(screenWidth, screenHeight);
+
+	if (!target.IsComplete())
+	{
+		std::cout << "ERROR::BENCHMARK::FRAMEBUFFER_INCOMPLETE" << std::endl;
+		return;
+	}
+
+	target.Bind();
+
+	if (_options.dumpFrameInterval > 0)
+	{
+#ifdef _WIN32
+		_mkdir("frames");
+#else
+		mkdir("frames", 0755);
+#endif
+	}
+
+	// GPU time of a frame is read a few frames later, when the query is done, so the CPU never waits for it
+	const unsigned queryCount = 4;
+	GLuint queries[queryCount];
+	glGenQueries(queryCount, queries);
+
+	// overdraw of the lit pass - fragment shader runs per pixel, core since GL 4.6
+	const bool measureOverdraw = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 6) ||
+		glfwExtensionSupported("GL_ARB_pipeline_statistics_query");
+
+	GLuint shadingQueries[queryCount] = {};
+
+	if (measureOverdraw)
+	{
+		glGenQueries(queryCount, shadingQueries);
+	}
+
+	std::vector<float> cpuMilliseconds(frames, 0.0f);
+	std::vector<float> gpuMilliseconds(frames, 0.0f);
+	std::vector<float> overdraw(frames, 0.0f);
+	std::vector<GLCallCounts> glCalls(frames);
+
+	const float pixelCount = (float)target.GetWidth() * target.GetHeight();
+
+	auto readQuery = [&](unsigned frame)
+	{
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[frame % queryCount], GL_QUERY_RESULT, &nanoseconds);
+		gpuMilliseconds[frame] = nanoseconds / 1000000.0f;
+
+		if (measureOverdraw)
+		{
+			GLuint64 invocations = 0;
+			glGetQueryObjectui64v(shadingQueries[frame % queryCount], GL_QUERY_RESULT, &invocations);
+			overdraw[frame] = invocations / pixelCount;
+		}
+	};
+
+	// script: the ball is released straight away and each fixed camera gets a third of the run
+	stuckToPaddle = false;
+	deltaTime = 1.0f / 60.0f;
+
+	// the uploads and set up done while loading are not part of any frame
+	TakeGLCallCounts();
+
+	for (unsigned frame = 0; frame < frames; frame++)
+	{
+		UpdateCameraView(1 + frame * 3 / frames);
+		camera.UpdateVectors();
+
+		if (frame >= queryCount)
+		{
+			readQuery(frame - queryCount);
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+
+		if (_profiler)
+		{
+			_profiler->BeginFrame();
+		}
+
+		glBeginQuery(GL_TIME_ELAPSED, queries[frame % queryCount]);
+		_shadingQuery = shadingQueries[frame % queryCount];
+
+		{
+			ProfileScope scope(_profiler.get(), "Update");
+			Update(window, deltaTime);
+		}
+
+		Render();
+
+		glEndQuery(GL_TIME_ELAPSED);
+
+		cpuMilliseconds[frame] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		glCalls[frame] = TakeGLCallCounts();
+
+		if (_options.dumpFrameInterval > 0 && frame % _options.dumpFrameInterval == 0)
+		{
+			std::ostringstream path;
+			path << "frames/frame_" << std::setw(4) << std::setfill('0') << frame << ".png";
+
+			const auto pixels = target.ReadPixels();
+			WritePng(path.str(), target.GetWidth(), target.GetHeight(), pixels.data());
+		}
+	}
+
+	for (unsigned frame = frames > queryCount ? frames - queryCount : 0; frame < frames; frame++)
+	{
+		readQuery(frame);
+	}
+
+	_shadingQuery = 0;
+
+	glDeleteQueries(queryCount, queries);
+
+	if (measureOverdraw)
+	{
+		glDeleteQueries(queryCount, shadingQueries);
+	}
+
+	target.Unbind();
+
+	std::ofstream csv("benchmark.csv");
+	csv << "frame,cpu_ms,gpu_ms,overdraw,draws,vertices,binds,redundant_binds,uniforms\n";
+
+	GLCallCounts totalCalls;
+
+	for (unsigned frame = 0; frame < frames; frame++)
+	{
+		const GLCallCounts& calls = glCalls[frame];
+
+		csv << frame << "," << cpuMilliseconds[frame] << "," << gpuMilliseconds[frame] << "," << overdraw[frame] << "," << calls.drawCalls << "," << calls.vertices
+			<< "," << calls.GetBinds() << "," << calls.redundantBinds << "," << calls.uniformUploads << "\n";
+
+		totalCalls.drawCalls += calls.drawCalls;
+		totalCalls.vertices += calls.vertices;
+		totalCalls.bufferBinds += calls.bufferBinds;
+		totalCalls.vertexArrayBinds += calls.vertexArrayBinds;
+		totalCalls.textureBinds += calls.textureBinds;
+		totalCalls.programBinds += calls.programBinds;
+		totalCalls.redundantBinds += calls.redundantBinds;
+		totalCalls.uniformUploads += calls.uniformUploads;
+	}
+
+	auto report = [frames](const char* name, std::vector<float> times)
+	{
+		if (times.empty())
+		{
+			return;
+		}
+
+		float total = 0.0f;
+
+		for (float time : times)
+		{
+			total += time;
+		}
+
+		std::sort(times.begin(), times.end());
+
+		std::cout << std::fixed << std::setprecision(3) << "BENCHMARK::" << name
+			<< " avg " << total / frames << " ms, median " << times[times.size() / 2] << " ms, min " << times.front() << " ms, max " << times.back() << " ms" << std::endl;
+	};
+
+	std::cout << "BENCHMARK::FRAMES " << frames << " at " << target.GetWidth() << "x" << target.GetHeight() << ", per-frame times in benchmark.csv" << std::endl;
+	report("CPU", cpuMilliseconds);
+	report("GPU", gpuMilliseconds);
+
+	if (measureOverdraw && frames > 0)
+	{
+		float total = 0.0f;
+
+		for (float frameOverdraw : overdraw)
+		{
+			total += frameOverdraw;
+		}
+
+		std::cout << std::setprecision(2) << "BENCHMARK::OVERDRAW lit fragments per pixel avg " << total / frames
+			<< (_options.depthPrepass ? " with" : " without") << " depth pre-pass" << std::endl;
+	}
+	else if (!measureOverdraw)
+	{
+		std::cout << "BENCHMARK::OVERDRAW not measured, needs GL 4.6 or GL_ARB_pipeline_statistics_query" << std::endl;
+	}
+
+	if (frames > 0)
+	{
+		std::cout << std::setprecision(1) << "BENCHMARK::GL_CALLS per frame: draws " << (float)totalCalls.drawCalls / frames
+			<< ", vertices " << (double)totalCalls.vertices / frames
+			<< ", binds " << (float)totalCalls.GetBinds() / frames << " (buffer " << (float)totalCalls.bufferBinds / frames
+			<< ", vertex array " << (float)totalCalls.vertexArrayBinds / frames << ", texture " << (float)totalCalls.textureBinds / frames
+			<< ", program " << (float)totalCalls.programBinds / frames << ", redundant " << (float)totalCalls.redundantBinds / frames
+			<< "), uniforms " << (float)totalCalls.uniformUploads / frames << std::endl;
+	}
+}
+
+void Application::RenderFrameStats()
+{
+	// one bar per frame from the right edge leftwards, 4 pixels per millisecond
+	const unsigned bars = std::min(_frameStats.GetCount(), 200u);
+	const float barWidth = 3.0f;
+	const float pixelsPerMillisecond = 4.0f;
+	const float left = 10.0f;
+	const float bottom = (float)screenHeight - 10.0f;
+	const float width = 200 * barWidth;
+
+	_spriteShader->use();
+
+	auto drawRect = [&](float x, float y, float w, float h, glm::vec3 colour)
+	{
+		ResetMatrices();
+		modelTranslate = glm::translate(modelTranslate, glm::vec3(x, y, 0.0f));
+		modelScale = glm::scale(modelScale, glm::vec3(w, h, 1.0f));
+
+		RenderSprite(_spriteShader, modelTranslate, modelScale, colour, _whiteTexture);
+		_statsBar->Render();
+	};
+
+	for (unsigned age = 0; age < bars; age++)
+	{
+		const float total = _frameStats.GetFrame(age).total;
+		const float height = std::min(total * pixelsPerMillisecond, 300.0f);
+
+		glm::vec3 colour = { 0.0f, 1.0f, 0.0f };
+
+		if (total > _frameStats.GetHitchMilliseconds())
+		{
+			colour = { 1.0f, 0.0f, 0.0f };
+		}
+		else if (total > 1000.0f / 60.0f)
+		{
+			colour = { 1.0f, 1.0f, 0.0f };
+		}
+
+		drawRect(left + width - (age + 1) * barWidth, bottom - height, barWidth - 1.0f, height, colour);
+	}
+
+	// the 60 Hz budget, then the rolling p99
+	drawRect(left, bottom - 1000.0f / 60.0f * pixelsPerMillisecond, width, 1.0f, { 1.0f, 1.0f, 1.0f });
+	drawRect(left, bottom - std::min(_frameStats.Summarize().p99 * pixelsPerMillisecond, 300.0f), width, 1.0f, { 1.0f, 0.0f, 1.0f });
+}
+
+void Application::WriteProfile()
+{
+	if (!_profiler)
+	{
+		return;
+	}
+
+	_profiler->WriteTrace(_options.profileTrace);
+	_profiler->PrintSummary();
+}
+
 void Application::Init()
 {
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// blending is switched on only for the HUD, everything in the world is opaque
+	RenderState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// filter across cube map face edges instead of clamping inside each face
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 	
 	state = GameState::Play;
 	gameWon = false;
@@ -235,26 +865,84 @@ void Application::Init()
 	// player score
 	score = 0;
 
+	// let the driver compile on its own threads while the models and textures load below
+	if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+	{
+		typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+		auto maxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+
+		if (maxShaderCompilerThreads)
+		{
+			// 0xFFFFFFFF - as many threads as the driver wants
+			maxShaderCompilerThreads(0xFFFFFFFF);
+			Shader::parallelCompile = true;
+		}
+	}
+
 	_shader = std::make_unique<Shader>("res\\projection.vert.glsl", "res\\projection.frag.glsl");
 	_spriteShader = std::make_unique<Shader>("res\\spriteProjection.vert.glsl", "res\\spriteProjection.frag.glsl");
+	_impostorShader = std::make_unique<Shader>("res\\ballImpostor.vert.glsl", "res\\ballImpostor.frag.glsl");
+	_skyboxShader = std::make_unique<Shader>("res\\skybox.vert.glsl", "res\\skybox.frag.glsl");
+	_depthShader = std::make_unique<Shader>("res\\depth.vert.glsl", "res\\depth.frag.glsl");
+	_lightCullingShader = std::make_unique<Shader>("res\\lightCulling.comp.glsl");
+	_particleShader = std::make_unique<Shader>("res\\particle.vert.glsl", "res\\particle.frag.glsl");
+	_particleUpdateShader = std::make_unique<Shader>("res\\particleUpdate.comp.glsl");
+	_particleEmitShader = std::make_unique<Shader>("res\\particleEmit.comp.glsl");
+
+	// models and textures decode on worker threads and are uploaded a few per frame from Run
+	_assetLoader = std::make_unique<AssetLoader>();
+
+	// every model reads its transform and colour from here, so it has to exist before they load
+	_modelInstances = std::make_unique<VertexBuffer>(nullptr, (int)(maxSceneObjects * sizeof(ModelInstance)), GL_DYNAMIC_STORAGE_BIT);
+	_modelInstances->SetLayout(
+		{
+			{"inModelRow0", Float4},
+			{"inModelRow1", Float4},
+			{"inModelRow2", Float4},
+			{"inColour", Float4},
+			{"inNormalRow0", Float4},
+			{"inNormalRow1", Float4},
+			{"inNormalRow2", Float4}
+		}
+	);
+
+	Model::instanceBuffer = _modelInstances.get();
+
+	_jobs = std::make_unique<JobSystem>();
+
+	_ballImpostors = std::make_unique<BallImpostors>(1024);
+	_tiledLighting = std::make_unique<TiledLighting>();
+
+	// sixteen bricks can be bursting at once before the budget runs out
+	_particles = std::make_unique<ParticleSystem>(4096);
+
+	// frame time graph, see RenderFrameStats
+	{
+		TextureImage white;
+		white.levels.push_back({ 1, 1, { 255, 255, 255, 255 } });
+		white.mipmaps = false;
+		_whiteTexture.Upload(white, TextureFilter::Nearest);
+
+		_statsBar = std::make_unique<Sprite>();
+		_statsBar->SetBuffers();
+	}
 	
-	// load background model
+	// load skybox
 	{
-		_background = std::make_unique<GameObject>();
-		_background->loadASSIMP("res\\models\\background\\cube.obj");
-		_background->setBuffers();
+		_skybox = std::make_unique<Skybox>();
+		_skybox->SetBuffers();
 
-		_background->texture.Load("res\\content\\skycube.png");
-		
-		_background->position = glm::vec3(0.0f);
-		_background->scale = glm::vec3(100.0f);
+		// the cross in skycube.png has 1024 pixel faces, a face spans about the width of the screen
+		_assetLoader->LoadTexture(_skybox->texture, "res\\content\\skycube.png", TextureImportSettings::Cubemap(1024));
+
+		// the lit cube it replaces only ever got the ambient term, its normals faced away from the light inside it
+		_skybox->colour = 0.4f * _lightColour;
 	}
 
 	// load player model
 	{
 		_player = std::make_unique<Player>();
-		_player->loadASSIMP("res\\models\\player\\cube.obj");
-		_player->setBuffers();
+		_assetLoader->LoadModel(*_player, "res\\models\\player\\cube.obj");
 
 		_player->position = glm::vec3(0.0f, -9.5f, 0.0f);
 		_player->scale = glm::vec3(1.5f, 0.125f, 0.5f);
@@ -262,14 +950,17 @@ void Application::Init()
 		
 		offset = _player->scale.x;
 
-		_player->texture.Load("res\\content\\player.png");
+		_assetLoader->LoadTexture(_player->texture, "res\\content\\player.png", TextureImportSettings::Mipmapped(256));
 	}
 
 	// load ball model
 	{
 		_ball = std::make_unique<Ball>();
-		_ball->loadASSIMP("res\\models\\ball\\sphere.obj");
-		_ball->setBuffers();
+		_assetLoader->LoadModel(*_ball, "res\\models\\ball\\sphere.obj", [](Model& ball)
+		{
+			// the ball is only a few pixels wide from the fixed cameras
+			ball.buildLods({ 16, 8, 4 }, { 24.0f, 12.0f, 6.0f });
+		});
 
 		_ball->position = glm::vec3
 		(
@@ -280,7 +971,7 @@ void Application::Init()
 		
 		_ball->scale = glm::vec3(0.1f, 0.1f, 0.1f);
 
-		_ball->texture.Load("res\\content\\newball.png");
+		_assetLoader->LoadTexture(_ball->texture, "res\\content\\newball.png", TextureImportSettings::Mipmapped(128));
 	}
 
 	// level
@@ -301,7 +992,7 @@ void Application::Init()
 			0.0f
 		);
 
-		_lives->texture.Load("res\\content\\heart.png");
+		_assetLoader->LoadTexture(_lives->texture, "res\\content\\heart.png", TextureImportSettings::Sprite(64));
 	}
 
 	// win
@@ -317,7 +1008,7 @@ void Application::Init()
 			0.0f
 		);
 		
-		_win->texture.Load("res\\content\\youWin.png");
+		_assetLoader->LoadTexture(_win->texture, "res\\content\\youWin.png", TextureImportSettings::Sprite(1024));
 		_win->active = false;
 	}
 	
@@ -334,13 +1025,28 @@ void Application::Init()
 			0.0f
 		);
 		
-		_gameover->texture.Load("res\\content\\gameOver.png");
+		_assetLoader->LoadTexture(_gameover->texture, "res\\content\\gameOver.png", TextureImportSettings::Sprite(1024));
 		_gameover->active = false;
 	}
 
 	LoadScore();
 
-	glEnable(GL_DEPTH_TEST);
+	// collect the shaders submitted at the top, by now they are usually done
+	_shader->Finalize();
+	_spriteShader->Finalize();
+	_impostorShader->Finalize();
+	_skyboxShader->Finalize();
+	_depthShader->Finalize();
+	_lightCullingShader->Finalize();
+	_particleShader->Finalize();
+	_particleUpdateShader->Finalize();
+	_particleEmitShader->Finalize();
+
+	std::cout << "SHADER::STARTUP " << _shader->buildMilliseconds + _spriteShader->buildMilliseconds + _impostorShader->buildMilliseconds + _skyboxShader->buildMilliseconds + _depthShader->buildMilliseconds
+		+ _lightCullingShader->buildMilliseconds + _particleShader->buildMilliseconds + _particleUpdateShader->buildMilliseconds + _particleEmitShader->buildMilliseconds << " ms"
+		<< (Shader::parallelCompile ? " (parallel)" : "") << std::endl;
+
+	RenderState::SetDepthTest(true);
 }
 
 void Application::Update(GLFWwindow* window, float dt)
@@ -349,12 +1055,9 @@ void Application::Update(GLFWwindow* window, float dt)
 	
 	orthoProgMatrix = glm::ortho(0.0f, (float)SCR_WIDTH, (float)SCR_HEIGHT, 0.0f, -1.0f, 1.0f);
 
-	glDisable(GL_DEPTH_TEST);
-	
 	_spriteShader->use();
 	_spriteShader->setFloatMat4("uView", orthoViewMatrix);
 	_spriteShader->setFloatMat4("uProjection", orthoProgMatrix);
-	_spriteShader->unuse();
 	
 	if (state == GameState::Play)
 	{
@@ -381,9 +1084,19 @@ void Application::Update(GLFWwindow* window, float dt)
 
 void Application::Render()
 {
+	ProfileScope renderScope(_profiler.get(), "Render");
+
+	// glClear obeys the write masks, the lit pass may have left depth writes off
+	RenderState::SetColourMask(true);
+	RenderState::SetDepthMask(true);
+
 	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	// each pass sets the state it needs, the cache drops what is already set
+	RenderState::SetDepthTest(true);
+	RenderState::SetBlend(false);
+
 	_shader->use();
 	
 	// move light source
@@ -391,88 +1104,184 @@ void Application::Render()
 	rotationMat = glm::rotate(rotationMat, _lightRotation, glm::vec3(1.0f, 1.0f, 0.0f));
 	_lightPos = glm::vec3(rotationMat * glm::vec4(_lightPos, 1.0));
 	
-	// background
-	ResetMatrices();
-	modelTranslate = translate(modelTranslate, glm::vec3(_background->position.x, _background->position.y, _background->position.z));
-	modelScale = scale(modelScale, glm::vec3(_background->scale.x, _background->scale.y, _background->scale.z));
-	modelRotation = rotate(modelRotation, _background->rotation += deltaTime / 8, glm::vec3(0.0f, 1.0f, 0.0f));
-
-	RenderObject(_shader, modelTranslate, modelScale, modelRotation, _background->colour, _background->texture);
-	_background->render();
-	
-	// player
-	ResetMatrices();
-	modelTranslate = translate(modelTranslate, glm::vec3(_player->position.x, _player->position.y, _player->position.z));
-	modelScale = scale(modelScale, glm::vec3(_player->scale.x, _player->scale.y, _player->scale.z));
-	modelRotation = glm::rotate(modelRotation, _player->rotation, glm::vec3(0.0f, 1.0f, 0.0f));
+	// camera matrices shared by every object this frame
+	viewMatrix = camera.GetViewMatrix();
+	projectionMatrix = glm::perspective(glm::radians(camera.Zoom), (float)screenWidth / (float)screenHeight, 0.1f, 1000.0f);
+	frustum.Update(projectionMatrix * viewMatrix);
 
-	RenderObject(_shader, modelTranslate, modelRotation, modelScale, _player->colour, _player->texture);
-	_player->render();
+	// the sky keeps turning, it is drawn after the scene
+	_skybox->rotation += deltaTime / 8;
+
+	// the object table - game state is only read and written here on the GL thread, the jobs below see a copy.
+	// Entries that come out the same as last frame stay clean, the static walls go last so the moving objects before them
+	// make up the changed range
+	sceneObjects.Begin();
+
+	// player
+	sceneObjects.Set(*_player, _player->position, _player->scale, _player->rotation, _player->colour, _player->texture);
 	
 	// ball
-	ResetMatrices();
-	modelTranslate = translate(modelTranslate, _ball->position);
-	modelRotation = glm::rotate(modelRotation, 0.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-	modelScale = scale(modelScale, _ball->scale);
-
-	RenderObject(_shader, modelTranslate, modelRotation, modelScale, _ball->colour, _ball->texture);
-	_ball->render();
+	if (_options.ballMesh)
+	{
+		sceneObjects.Set(*_ball, _ball->position, _ball->scale, 0.0f, _ball->colour, _ball->texture);
+	}
 	
 	// level - 5x10 bricks for the player to destroy
 	for (int y = 0; y < numbBricksHigh; y++)
 	{
 		for (int x = 0; x < numbBricksWide; x++)
 		{
-			ResetMatrices();
-			modelTranslate = translate(modelTranslate, bricks[y][x]->position);
-			modelScale = scale(modelScale, bricks[y][x]->scale);
-			modelRotation = rotate(modelRotation, bricks[y][x]->rotation += deltaTime, glm::vec3(0.0f, 1.0f, 0.0f));
-			
-			RenderObject(_shader, modelTranslate, modelRotation, modelScale, bricks[y][x]->colour, bricks[y][x]->texture);
-			bricks[y][x]->render();
+			auto& brick = bricks[y][x];
+			brick->rotation += deltaTime;
+
+			sceneObjects.Set(*brick, brick->position, brick->scale, brick->rotation, brick->colour, brick->texture);
 		}
 	}
 
-	// bounds
-	// left bound
-	for (int i = 0; i < boundBlocks; i++)
+	// walls, each baked into a single mesh
+	sceneObjects.Set(*_wallLeft, _wallLeft->position, _wallLeft->scale, _wallLeft->rotation, _wallLeft->colour, _wallLeft->texture);
+	sceneObjects.Set(*_wallRight, _wallRight->position, _wallRight->scale, _wallRight->rotation, _wallRight->colour, _wallRight->texture);
+	sceneObjects.Set(*_wallTop, _wallTop->position, _wallTop->scale, _wallTop->rotation, _wallTop->colour, _wallTop->texture);
+
+	sceneObjects.End();
+
+	// transforms, culling, level of detail and the front to back order, spread over the worker threads
 	{
-		ResetMatrices();
-		modelTranslate = translate(modelTranslate, boundLeft[i]->position);
-		modelScale = scale(modelScale, boundLeft[i]->scale);
-		modelRotation = rotate(modelRotation, boundLeft[i]->rotation, glm::vec3(0.0f, 1.0f, 0.0f));
+		ProfileScope scope(_profiler.get(), "Prepare");
+		PrepareDrawItems();
+	}
 
-		RenderObject(_shader, modelTranslate, modelRotation, modelScale, boundLeft[i]->colour, boundLeft[i]->texture);
-		boundLeft[i]->render();
+	{
+		ProfileScope scope(_profiler.get(), "LightCulling");
+		CullLights();
 	}
 
-	// right bound
-	for (int i = 0; i < boundBlocks; i++)
+	// depth only from the position stream, then the lit pass shades just the fragments that ended up in front
+	if (_options.depthPrepass)
 	{
-		ResetMatrices();
-		modelTranslate = translate(modelTranslate, boundRight[i]->position);
-		modelScale = scale(modelScale, boundRight[i]->scale);
-		modelRotation = rotate(modelRotation, boundRight[i]->rotation, glm::vec3(0.0f, 1.0f, 0.0f));
+		ProfileScope scope(_profiler.get(), "DepthPrepass");
 
-		RenderObject(_shader, modelTranslate, modelRotation, modelScale, boundRight[i]->colour, boundRight[i]->texture);
-		boundRight[i]->render();
+		RenderState::SetColourMask(false);
+
+		_depthShader->use();
+		_depthShader->setFloatMat4("uView", viewMatrix);
+		_depthShader->setFloatMat4("uProjection", projectionMatrix);
+
+		for (unsigned i : drawOrder)
+		{
+			const auto& item = drawItems[i];
+			item.model->renderDepth(item.lod, i);
+		}
+
+		RenderState::SetColourMask(true);
+		RenderState::SetDepthMask(false);
+		RenderState::SetDepthFunc(GL_LEQUAL);
+
+		_shader->use();
 	}
 
-	// top bound
-	for (int i = 0; i < topBlocks; i++)
 	{
-		ResetMatrices();
-		modelTranslate = translate(modelTranslate, boundTop[i]->position);
-		modelScale = scale(modelScale, boundTop[i]->scale);
-		modelRotation = rotate(modelRotation, boundTop[i]->rotation, glm::vec3(0.0f, 1.0f, 0.0f));
+		ProfileScope scope(_profiler.get(), "Opaque");
 
-		RenderObject(_shader, modelTranslate, modelRotation, modelScale, boundTop[i]->colour, boundTop[i]->texture);
-		boundTop[i]->render();
+		if (_shadingQuery)
+		{
+			glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS, _shadingQuery);
+		}
+
+		SetFrameUniforms(_shader);
+
+		// the transforms and colours are in the instance buffer already, only the texture changes between draws
+		for (unsigned i : drawOrder)
+		{
+			const auto& item = drawItems[i];
+
+			item.texture->Bind();
+			item.model->render(item.lod, i);
+		}
+
+		if (_shadingQuery)
+		{
+			glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS);
+		}
 	}
 
-	_shader->unuse();
-	
-	glDisable(GL_DEPTH_TEST);
+	RenderState::SetDepthMask(true);
+	RenderState::SetDepthFunc(GL_LESS);
+
+	// balls as ray-traced impostors, all in one instanced draw
+	if (!_options.ballMesh)
+	{
+		ProfileScope scope(_profiler.get(), "Ball");
+
+		_ballImpostors->Clear();
+
+		const glm::vec3 center = _ball->position + _ball->boundsCenter * _ball->scale.x;
+		const float radius = _ball->boundsRadius * _ball->scale.x;
+
+		if (frustum.IsSphereVisible(center, radius))
+		{
+			_ballImpostors->Add(center, radius);
+		}
+
+		_impostorShader->use();
+		_impostorShader->setFloatMat4("uView", viewMatrix);
+		_impostorShader->setFloatMat4("uProjection", projectionMatrix);
+		_impostorShader->setFloatMat4("uInverseView", glm::inverse(viewMatrix));
+		_impostorShader->setFloat3("uLightPosition", _lightPos);
+		_impostorShader->setFloat3("uLightColour", _lightColour);
+		_impostorShader->setFloat3("uObjectColour", _ball->colour);
+
+		_ball->texture.Bind();
+		_ballImpostors->Render();
+
+		_shader->use();
+	}
+
+	// sky last, on the far plane - early-z rejects it wherever the scene was drawn, so only the empty pixels sample it
+	if (_skybox->texture.GetTexture() != 0)
+	{
+		ProfileScope scope(_profiler.get(), "Skybox");
+
+		RenderState::SetDepthFunc(GL_LEQUAL);
+
+		_skyboxShader->use();
+		_skyboxShader->setFloatMat4("uView", glm::mat4(glm::mat3(viewMatrix)));
+		_skyboxShader->setFloatMat4("uProjection", projectionMatrix);
+		_skyboxShader->setFloatMat4("uModel", glm::rotate(glm::mat4(1.0f), _skybox->rotation, glm::vec3(0.0f, 1.0f, 0.0f)));
+		_skyboxShader->setFloat3("uColour", _skybox->colour);
+
+		_skybox->texture.Bind();
+		_skybox->Render();
+
+		RenderState::SetDepthFunc(GL_LESS);
+	}
+
+	// sparks of the destroyed bricks, simulated and drawn without the CPU touching a particle.
+	// Added on top of the scene, tested against its depth but not writing any
+	{
+		ProfileScope scope(_profiler.get(), "Particles");
+
+		_particles->Update(*_particleUpdateShader, *_particleEmitShader, deltaTime);
+
+		RenderState::SetBlend(true);
+		RenderState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE);
+		RenderState::SetDepthMask(false);
+
+		_particleShader->use();
+		_particleShader->setFloatMat4("uView", viewMatrix);
+		_particleShader->setFloatMat4("uProjection", projectionMatrix);
+
+		_particles->Render();
+
+		RenderState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		RenderState::SetDepthMask(true);
+	}
+
+	// the HUD is the transparent pass, blended over the scene without depth
+	RenderState::SetDepthTest(false);
+	RenderState::SetBlend(true);
+
+	ProfileScope hudScope(_profiler.get(), "HUD");
 	
 	_spriteShader->use();
 	
@@ -528,27 +1337,23 @@ void Application::Render()
 			sprite->Render();
 		}
 	}
-
-	glDrawArrays(GL_TRIANGLES, 0, 36);
-
-	_spriteShader->unuse();
 }
 
 void Application::BuildLevel()
 {
 	auto blockTexture = std::make_unique<Texture>();
-	blockTexture->Load("res\\content\\block.png");
+	// a brick is about 50 pixels wide on screen
+	_assetLoader->LoadTexture(*blockTexture, "res\\content\\block.png", TextureImportSettings::Mipmapped(256));
 	
 	auto crackedTexture = std::make_unique<Texture>();
-	crackedTexture->Load("res\\content\\crackedBlock.png");
+	_assetLoader->LoadTexture(*crackedTexture, "res\\content\\crackedBlock.png", TextureImportSettings::Mipmapped(256));
 	
 	for (int y = 0; y < numbBricksHigh; y++)
 	{
 		for (int x = 0; x < numbBricksWide; x++)
 		{
 			_brick = std::make_unique<Brick>();
-			_brick->loadASSIMP("res\\models\\brick\\cube.obj");
-			_brick->setBuffers();
+			_assetLoader->LoadModel(*_brick, "res\\models\\brick\\cube.obj");
 
 			_brick->scale = glm::vec3(0.5f, 0.5f, 0.5f);
 			_brick->position = (glm::vec3(-9.0f + (2.0f * x), (2.0f * y), 0.0f));
@@ -585,53 +1390,43 @@ void Application::BuildLevel()
 		}
 	}
 
-	// left bound
+	// the walls never move, so the blocks of each are baked into one mesh at load time and cost a single draw whatever their length
+	std::vector<glm::mat4> leftBlocks;
+	std::vector<glm::mat4> rightBlocks;
+	std::vector<glm::mat4> wallTopBlocks;
+
 	for (int i = 0; i < boundBlocks; i++)
 	{
-		_brickLeft = std::make_unique<Brick>();
-		_brickLeft->loadASSIMP("res\\models\\brick\\cube.obj");
-		_brickLeft->setBuffers();
-
-		_brickLeft->scale = glm::vec3(0.5f, 0.5f, 0.5f);
-		_brickLeft->position = (glm::vec3(-12.0f, -10.0f + i, 0.0f));
-		_brickLeft->colour = { 1.0f, 1.0f, 1.0f };
-
-		_brickLeft->texture = *std::move(blockTexture);
-
-		boundLeft[i] = std::move(_brickLeft);
+		leftBlocks.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(-12.0f, -10.0f + i, 0.0f)), glm::vec3(0.5f)));
+		rightBlocks.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(12.0f, -10.0f + i, 0.0f)), glm::vec3(0.5f)));
 	}
 
-	// top bound
 	for (int i = 0; i < topBlocks; i++)
 	{
-		_brickTop = std::make_unique<Brick>();
-		_brickTop->loadASSIMP("res\\models\\brick\\cube.obj");
-		_brickTop->setBuffers();
+		wallTopBlocks.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(-12.0f + i, 10.0f, 0.0f)), glm::vec3(0.5f)));
+	}
 
-		_brickTop->scale = glm::vec3(0.5f, 0.5f, 0.5f);
-		_brickTop->position = (glm::vec3(-12.0f + i, 10.0f, 0.0f));
-		_brickTop->colour = { 0.0f, 1.0f, 0.0f };
+	BuildWall(_wallLeft, leftBlocks, { 1.0f, 1.0f, 1.0f }, *blockTexture);
+	BuildWall(_wallTop, wallTopBlocks, { 0.0f, 1.0f, 0.0f }, *blockTexture);
+	BuildWall(_wallRight, rightBlocks, { 1.0f, 0.0f, 0.0f }, *blockTexture);
+}
 
-		_brickTop->texture = *std::move(blockTexture);
+void Application::BuildWall(std::unique_ptr<GameObject>& wall, const std::vector<glm::mat4>& blocks, glm::vec3 colour, const Texture& texture)
+{
+	wall = std::make_unique<GameObject>();
 
-		boundTop[i] = std::move(_brickTop);
-	}
-	
-	// right bound
-	for (int i = 0; i < boundBlocks; i++)
+	// the blocks are baked on the loader's worker, right after the cube is read
+	_assetLoader->LoadModel(*wall, "res\\models\\brick\\cube.obj", [blocks](Model& model)
 	{
-		_brickRight = std::make_unique<Brick>();
-		_brickRight->loadASSIMP("res\\models\\brick\\cube.obj");
-		_brickRight->setBuffers();
+		model.bakeInstances(blocks);
+	});
 
-		_brickRight->scale = glm::vec3(0.5f, 0.5f, 0.5f);
-		_brickRight->position = (glm::vec3(12.0f, -10.0f + i, 0.0f));
-		_brickRight->colour = { 1.0f, 0.0f, 0.0f };
+	// the blocks are in world space already
+	wall->scale = glm::vec3(1.0f, 1.0f, 1.0f);
+	wall->rotation = 0.0f;
+	wall->colour = colour;
 
-		_brickRight->texture = *std::move(blockTexture);
-
-		boundRight[i] = std::move(_brickRight);
-	}
+	wall->texture = texture;
 }
 
 void Application::UpdateCameraView(unsigned view)
@@ -722,8 +1517,6 @@ void Application::UpdatePlayerPosition(GLFWwindow* window)
 				_player->position.z
 			);
 		}
-
-		glDrawArrays(GL_TRIANGLES, 0, 36);
 	}
 	else if (_player->lives <= 0)
 	{
@@ -835,8 +1628,6 @@ void Application::UpdateBallPosition(GLFWwindow* window)
 				}
 			}
 		}
-
-		glDrawArrays(GL_TRIANGLES, 0, 36);
 	}
 }
 
@@ -901,6 +1692,9 @@ void Application::SetDeadBrick(const int x, const int y)
 {
 	bricks[y][x]->brickDying = true;
 	bricks[y][x]->brickAlive = false;
+
+	explosionLights.push_back({ bricks[y][x]->position, bricks[y][x]->colour, 0.0f });
+	_particles->Burst(bricks[y][x]->position, bricks[y][x]->colour);
 	
 	score += 3;
 	SetScore();
@@ -924,29 +1718,293 @@ void Application::RenderSprite(std::unique_ptr<Shader>& shader, glm::mat4 transl
 	shader->setFloatMat4("uProjection", glm::mat4(orthoProgMatrix));
 	shader->setFloat3("uColour", glm::vec3(colour.x, colour.y, colour.z));
 
-	glBindTexture(GL_TEXTURE_2D, texture.GetTexture());
+	texture.Bind();
 }
 
-void Application::RenderObject(std::unique_ptr<Shader>& shader, glm::mat4 translation, glm::mat4 rotation, glm::mat4 scale, glm::vec3 colour, Texture& texture)
+void Application::SetFrameUniforms(std::unique_ptr<Shader>& shader)
 {
 	// lighting
-	shader->setFloat3("uObjectColour", glm::vec3(colour.x, colour.y, colour.z));
 	shader->setFloat3("uLightColour", glm::vec3(_lightColour.x, _lightColour.y, _lightColour.z));
 	shader->setFloat3("uLightPosition", glm::vec3(_lightPos.x, _lightPos.y, _lightPos.z));
 	shader->setFloat3("uViewPosition", glm::vec3(camera.Position.x, camera.Position.y, camera.Position.z));
 
-	shader->setFloatMat4("uModel", glm::mat4(translation * rotation * scale));
-	shader->setFloatMat4("uView", glm::mat4(camera.GetViewMatrix()));
-	shader->setFloatMat4("uProjection", glm::mat4(glm::perspective(glm::radians(camera.Zoom), (float)screenWidth / (float)screenHeight, 0.1f, 1000.0f)));
+	shader->setFloatMat4("uView", viewMatrix);
+	shader->setFloatMat4("uProjection", projectionMatrix);
+}
 
-	glBindTexture(GL_TEXTURE_2D, texture.GetTexture());
+void Application::CullLights()
+{
+	_tiledLighting->Clear();
+
+	// the ball glows - the light sits in front of the field so the faces towards the camera catch it
+	const glm::vec3 inFront = glm::vec3(0.0f, 0.0f, 1.5f);
+
+	_tiledLighting->Add({ _ball->position + inFront, 6.0f, glm::vec3(1.0f, 0.85f, 0.6f), 4.0f });
+
+	// destroyed bricks flash in their own colour and fade out
+	for (auto& light : explosionLights)
+	{
+		light.age += deltaTime;
+
+		const float fade = 1.0f - glm::clamp(light.age / explosionLightLifetime, 0.0f, 1.0f);
+		_tiledLighting->Add({ light.position + inFront, 5.0f, light.colour, 8.0f * fade });
+	}
+
+	explosionLights.erase(std::remove_if(explosionLights.begin(), explosionLights.end(), [](const ExplosionLight& light)
+	{
+		return light.age >= explosionLightLifetime;
+	}), explosionLights.end());
+
+	// --lights, spread over the field on fixed orbits so runs can be compared. Together they cover
+	// the 24 x 20 field about eight times over
+	extraLightTime += deltaTime;
+
+	const float extraLightRadius = glm::clamp(glm::sqrt(8.0f * 24.0f * 20.0f / (3.14159265f * glm::max(_options.extraLights, 1u))), 0.75f, 3.0f);
+
+	for (unsigned i = 0; i < _options.extraLights; i++)
+	{
+		const float u = glm::fract(i * 0.6180339f);
+		const float v = glm::fract(i * 0.7548777f);
+		const float phase = extraLightTime * (0.5f + u) + i;
+
+		const glm::vec3 position = glm::vec3(-12.0f + 24.0f * u, -10.0f + 20.0f * v, 1.5f) + 1.5f * glm::vec3(glm::cos(phase), glm::sin(phase), 0.0f);
+		const glm::vec3 colour = glm::vec3(0.5f + 0.5f * glm::cos(6.2831853f * u), 0.5f + 0.5f * glm::cos(6.2831853f * (u + 0.33f)), 0.5f + 0.5f * glm::cos(6.2831853f * (u + 0.67f)));
+
+		_tiledLighting->Add({ position, extraLightRadius, colour, 2.0f });
+	}
+
+	// the tiles have to line up with gl_FragCoord, which follows the viewport even after the window was resized
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	_tiledLighting->Cull(*_lightCullingShader, viewMatrix, projectionMatrix, viewport[2], viewport[3]);
+
+	// the tile lists stay bound for the lit pass, only the tile grid changes with the viewport
+	_shader->use();
+	_shader->setInt("uTilesX", (int)_tiledLighting->GetTilesX());
+	_shader->setInt("uTilesY", (int)_tiledLighting->GetTilesY());
+}
+
+void Application::PrepareDrawItems()
+{
+	// objects past the instance buffer are not drawn
+	const auto count = glm::min(sceneObjects.GetCount(), maxSceneObjects);
+
+	// a moved camera changes the level of detail, distance and visibility of everything, a changed object only its own
+	const glm::mat4 viewProjection = projectionMatrix * viewMatrix;
+	const bool refreshAll = viewProjection != preparedViewProjection || count != preparedCount || screenHeight != preparedScreenHeight;
+
+	const auto dirtyEnd = sceneObjects.dirty.begin() + count;
+	const auto firstDirty = (unsigned)(std::find(sceneObjects.dirty.begin(), dirtyEnd, 1) - sceneObjects.dirty.begin());
+
+	// nothing moved, last frame's draw order still holds
+	if (!refreshAll && firstDirty == count)
+	{
+		return;
+	}
+
+	preparedViewProjection = viewProjection;
+	preparedCount = count;
+	preparedScreenHeight = screenHeight;
+
+	// every job writes only its own range of these
+	drawItems.resize(count);
+	modelInstances.resize(count);
+	boundsX.resize(count);
+	boundsY.resize(count);
+	boundsZ.resize(count);
+	boundsRadius.resize(count);
+	visibleItems.resize(count);
+	chunkOrders.resize((count + prepareChunkSize - 1) / prepareChunkSize);
+
+	_jobs->ParallelFor(count, prepareChunkSize, [this, refreshAll](unsigned begin, unsigned end)
+	{
+		const auto& dirty = sceneObjects.dirty;
+
+		// a clean chunk keeps its draw items and its sorted order from an earlier frame
+		if (!refreshAll && std::find(dirty.begin() + begin, dirty.begin() + end, 1) == dirty.begin() + end)
+		{
+			return;
+		}
+
+		// new transforms and bounds for each run of changed objects
+		for (unsigned i = begin; i < end;)
+		{
+			if (!dirty[i])
+			{
+				i++;
+				continue;
+			}
+
+			unsigned runEnd = i + 1;
+
+			while (runEnd < end && dirty[runEnd])
+			{
+				runEnd++;
+			}
+
+			ComposeTransforms(&sceneObjects.positionX[i], &sceneObjects.positionY[i], &sceneObjects.positionZ[i], &sceneObjects.rotations[i],
+				&sceneObjects.scaleX[i], &sceneObjects.scaleY[i], &sceneObjects.scaleZ[i], runEnd - i, &modelInstances[i]);
+
+			for (; i < runEnd; i++)
+			{
+				PrepareObject(i);
+			}
+		}
+
+		for (unsigned i = begin; i < end; i++)
+		{
+			PrepareDrawItem(i);
+		}
+
+		frustum.CullSpheres(&boundsX[begin], &boundsY[begin], &boundsZ[begin], &boundsRadius[begin], end - begin, &visibleItems[begin]);
+
+		auto& order = chunkOrders[begin / prepareChunkSize];
+		order.clear();
+
+		for (unsigned i = begin; i < end; i++)
+		{
+			if (visibleItems[i])
+			{
+				order.push_back(i);
+			}
+		}
+
+		std::sort(order.begin(), order.end(), [](unsigned a, unsigned b)
+		{
+			return drawItems[a].distance < drawItems[b].distance;
+		});
+	});
+
+	// only the range between the first and the last changed object goes to the instance buffer
+	if (firstDirty < count)
+	{
+		unsigned lastDirty = count;
+
+		while (!sceneObjects.dirty[lastDirty - 1])
+		{
+			lastDirty--;
+		}
+
+		_modelInstances->SetData(&modelInstances[firstDirty], (int)((lastDirty - firstDirty) * sizeof(ModelInstance)), (int)(firstDirty * sizeof(ModelInstance)));
+	}
+
+	sceneObjects.ClearDirty();
+
+	// nearest first, so early-z rejects the hidden parts of everything drawn after
+	drawOrder.clear();
+
+	for (const auto& order : chunkOrders)
+	{
+		const auto middle = drawOrder.size();
+		drawOrder.insert(drawOrder.end(), order.begin(), order.end());
+
+		std::inplace_merge(drawOrder.begin(), drawOrder.begin() + middle, drawOrder.end(), [](unsigned a, unsigned b)
+		{
+			return drawItems[a].distance < drawItems[b].distance;
+		});
+	}
+
+	_drawnObjects = (unsigned)drawOrder.size();
+	_culledObjects = count - _drawnObjects;
+}
+
+void Application::PrepareObject(unsigned index) const
+{
+	const Model& model = *sceneObjects.models[index];
+	const auto& rows = modelInstances[index].rows;
+	auto& item = drawItems[index];
+
+	item.model = sceneObjects.models[index];
+	item.texture = sceneObjects.textures[index];
+
+	modelInstances[index].colour = glm::vec4(sceneObjects.colours[index], 1.0f);
+
+	// move the local bounding sphere into world space, the radius grows with the largest scale axis
+	const glm::vec4 localCenter = glm::vec4(model.boundsCenter, 1.0f);
+	const float maxScale = glm::max(glm::abs(sceneObjects.scaleX[index]), glm::max(glm::abs(sceneObjects.scaleY[index]), glm::abs(sceneObjects.scaleZ[index])));
+
+	boundsX[index] = glm::dot(rows[0], localCenter);
+	boundsY[index] = glm::dot(rows[1], localCenter);
+	boundsZ[index] = glm::dot(rows[2], localCenter);
+	boundsRadius[index] = model.boundsRadius * maxScale;
+}
+
+void Application::PrepareDrawItem(unsigned index) const
+{
+	const glm::vec3 center = glm::vec3(boundsX[index], boundsY[index], boundsZ[index]);
+	auto& item = drawItems[index];
+
+	item.lod = item.model->selectLod(ProjectedRadius(center, boundsRadius[index]));
+
+	const glm::vec3 toCamera = center - camera.Position;
+	item.distance = glm::dot(toCamera, toCamera);
+}
+
+float Application::ProjectedRadius(glm::vec3 center, float radius) const
+{
+	const float distance = glm::max(glm::length(center - camera.Position), 0.1f);
+
+	// pixels covered by the radius on the vertical axis of the perspective projection
+	return radius / distance * (screenHeight * 0.5f) / glm::tan(glm::radians(camera.Zoom) * 0.5f);
+}
+
+void Application::ReportLods()
+{
+	const glm::vec3 cameraPosition = camera.Position;
+	const float cameraPitch = camera.Pitch;
+	const float cameraYaw = camera.Yaw;
+	const bool cameraFree = freeCamera;
+
+	const float ballRadius = _ball->boundsRadius * _ball->scale.x;
+	const auto& fullMesh = _ball->lods[0];
+	const float fullVertices = fullMesh.acmr * fullMesh.triangleCount;
+
+	std::cout << "ball levels of detail\n";
+
+	for (size_t i = 0; i < _ball->lods.size(); i++)
+	{
+		const auto& lod = _ball->lods[i];
+		std::cout << "  LOD " << i << ": " << lod.triangleCount << " triangles, ACMR " << std::fixed << std::setprecision(2) << lod.acmr << "\n";
+	}
+
+	std::cout << "\ncamera  distance  radius(px)  LOD  triangles  vertex shader runs  saved\n";
+
+	for (unsigned view = 1; view <= 4; view++)
+	{
+		UpdateCameraView(view);
+		camera.UpdateVectors();
+
+		const glm::vec3 center = _ball->position + _ball->boundsCenter * _ball->scale.x;
+		const float screenRadius = ProjectedRadius(center, ballRadius);
+		const unsigned lodIndex = _ball->selectLod(screenRadius);
+		const auto& lod = _ball->lods[lodIndex];
+
+		// post-transform cache misses are what the vertex shader actually runs for
+		const float vertices = lod.acmr * lod.triangleCount;
+
+		std::cout << std::setw(6) << view
+			<< std::setw(10) << std::setprecision(1) << glm::length(center - camera.Position)
+			<< std::setw(12) << screenRadius
+			<< std::setw(5) << lodIndex
+			<< std::setw(11) << lod.triangleCount
+			<< std::setw(20) << std::setprecision(0) << vertices
+			<< std::setw(6) << std::setprecision(0) << 100.0f * (1.0f - vertices / fullVertices) << "%\n";
+	}
+
+	std::cout << std::endl;
+
+	camera.Position = cameraPosition;
+	camera.Pitch = cameraPitch;
+	camera.Yaw = cameraYaw;
+	freeCamera = cameraFree;
+	camera.UpdateVectors();
 }
 
 void Application::ResetMatrices()
 {
 	modelTranslate = glm::mat4(1.0f);
 	modelScale = glm::mat4(1.0f);
-	modelRotation = glm::mat4(1.0f);
 }
 
 void Application::LoadScore()
@@ -968,7 +2026,7 @@ void Application::LoadScore()
 				0.0f
 			);
 			
-			sprite->texture.Load("res\\content\\newScore.png");
+			_assetLoader->LoadTexture(sprite->texture, "res\\content\\newScore.png", TextureImportSettings::Sprite(256));
 		}
 		else
 		{
@@ -980,7 +2038,7 @@ void Application::LoadScore()
 				0.0f
 			);
 			
-			sprite->texture.Load("res\\content\\0.png");
+			_assetLoader->LoadTexture(sprite->texture, "res\\content\\0.png", TextureImportSettings::Sprite(128));
 		}
 		
 		scoreObject.push_back(std::move(sprite));
@@ -992,7 +2050,8 @@ void Application::LoadScore()
 		auto texture = std::make_unique<Texture>();
 		auto file = "res\\content\\" + std::to_string(i) + ".png";
 		
-		texture->Load(file);
+		// drawn at 40 pixels, 128 keeps the halved 67x66 image
+		_assetLoader->LoadTexture(*texture, file, TextureImportSettings::Sprite(128));
 		
 		scoreText.push_back(std::move(texture));
 	}
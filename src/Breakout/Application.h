@@ -1,33 +1,102 @@
 #pragma once
 
+#include <string>
+
 #include <glm/glm.hpp>
 
+#include "AssetLoader.h"
+#include "FrameStats.h"
+#include "GLCallCounter.h"
+#include "GpuProfiler.h"
+#include "JobSystem.h"
 #include "Shader.h"
+#include "TiledLighting.h"
 #include "VertexArray.h"
 
 #include "models/Ball.h"
+#include "models/BallImpostors.h"
 #include "models/Brick.h"
 #include "models/Model.h"
+#include "models/ParticleSystem.h"
 #include "models/Player.h"
+#include "models/Skybox.h"
 #include "models/Sprite.h"
 #include "models/GameObject.h"
 
 struct GLFWwindow;
 
+// context used by --headless. The window is always created, hidden - the vendored GLFW is the Win32 prebuilt,
+// which needs a desktop to create one, so this is not a surfaceless or display-less mode
+enum class HeadlessContext
+{
+	// the platform's usual driver
+	Native,
+	// GLFW's EGL context API, only works where an EGL driver is installed (ANGLE, Mesa)
+	EGL,
+	// GLFW's OSMesa context API, needs Mesa's OSMesa library next to the executable to render on llvmpipe without a GPU
+	OSMesa
+};
+
+// command line switches, see Main.cpp
+struct LaunchOptions
+{
+	// print the ball's level of detail and vertex work at every camera preset, then exit
+	bool lodReport = false;
+
+	// draw balls as tessellated sphere meshes instead of ray-traced impostors
+	bool ballMesh = false;
+
+	// render a scripted scene into an offscreen framebuffer for benchmarkFrames frames, report the frame times and exit
+	bool headless = false;
+	HeadlessContext headlessContext = HeadlessContext::Native;
+	unsigned benchmarkFrames = 600;
+
+	// write every Nth benchmark frame to frames/frame_NNNN.png, 0 writes none
+	unsigned dumpFrameInterval = 0;
+
+	// time every render pass on the CPU and GPU and write a chrome://tracing JSON file here on exit
+	std::string profileTrace;
+
+	// lay down the depth of the opaque objects first, so the lit pass shades each pixel about once
+	bool depthPrepass = false;
+
+	// point lights orbiting over the field on top of the ball and brick lights, to load the tiled light culling.
+	// Their radius shrinks as the count grows, so each pixel is lit by about as many of them at any count
+	unsigned extraLights = 0;
+};
+
 class Application
 {
 public:
-	void Run();
+	void Run(const LaunchOptions& options = LaunchOptions());
+
+	// objects drawn and rejected by the view frustum in the last frame
+	unsigned GetDrawnObjects() const { return _drawnObjects; }
+	unsigned GetCulledObjects() const { return _culledObjects; }
 
 private:
 	void Init();
+
+	// releases every GL object while the context is still current, Run calls it before glfwTerminate
+	void Shutdown();
 	void Update(GLFWwindow* window, float dt);
 	void Render();
 
+	// the --headless loop, fixed time step and camera script so runs can be compared
+	void RunBenchmark(GLFWwindow* window);
+
+	// writes the --profile trace and prints the per-pass averages
+	void WriteProfile();
+
+	// graph of the recent frame times in the corner of the screen, toggled with F3
+	void RenderFrameStats();
+
 	void ProcessInput(GLFWwindow* window);
 	void ProcessCameras(GLFWwindow* window);
 
 	void BuildLevel();
+	// one wall of blocks with the given transforms, merged into a single mesh when the brick model has loaded
+	void BuildWall(std::unique_ptr<GameObject>& wall, const std::vector<glm::mat4>& blocks, glm::vec3 colour, const Texture& texture);
 	void UpdateCameraView(unsigned view);
 	bool IsTheGameWon();
 	
@@ -44,14 +113,66 @@ private:
 	void LoadScore();
 	void SetScore();
 
-	void RenderObject(std::unique_ptr<Shader>& shader, glm::mat4 translation, glm::mat4 rotation, glm::mat4 scale, glm::vec3 colour, Texture& texture);
+	// light and camera uniforms shared by every object of the lit pass
+	void SetFrameUniforms(std::unique_ptr<Shader>& shader);
 	void RenderSprite(std::unique_ptr<Shader>& shader, glm::mat4 translation, glm::mat4 scale, glm::vec3 colour, Texture& texture);
 	void ResetMatrices();
+
+	// gathers this frame's point lights and culls them into screen tiles for the lit pass
+	void CullLights();
+
+	// fills drawItems, the instance buffer and drawOrder from sceneObjects with jobs over chunks of the table.
+	// Only changed objects get new transforms, and nothing is done while neither they nor the camera moved
+	void PrepareDrawItems();
+	// colour and world bounds of an object whose transform was just built
+	void PrepareObject(unsigned index) const;
+	// level of detail and camera distance
+	void PrepareDrawItem(unsigned index) const;
+
+	float ProjectedRadius(glm::vec3 center, float radius) const;
+	void ReportLods();
 	
 	std::unique_ptr<Shader> _shader;
 	std::unique_ptr<Shader> _spriteShader;
+	std::unique_ptr<Shader> _impostorShader;
+	std::unique_ptr<Shader> _skyboxShader;
+	std::unique_ptr<Shader> _depthShader;
+	std::unique_ptr<Shader> _lightCullingShader;
+	std::unique_ptr<Shader> _particleShader;
+	std::unique_ptr<Shader> _particleUpdateShader;
+	std::unique_ptr<Shader> _particleEmitShader;
+
+	std::unique_ptr<BallImpostors> _ballImpostors;
+	std::unique_ptr<TiledLighting> _tiledLighting;
+	std::unique_ptr<ParticleSystem> _particles;
+
+	// prepares the draw items of a frame on all cores, see PrepareDrawItems
+	std::unique_ptr<JobSystem> _jobs;
+
+	// ModelInstance of every draw item, see Model::instanceBuffer
+	std::unique_ptr<VertexBuffer> _modelInstances;
+
+	// streams models and textures in while the first frames are drawn
+	std::unique_ptr<AssetLoader> _assetLoader;
+
+	// only with --profile
+	std::unique_ptr<GpuProfiler> _profiler;
 
-	std::unique_ptr<GameObject> _background;
+	// written to frame_stats.csv on exit
+	FrameStats _frameStats;
+	bool _showFrameStats = false;
+	bool _frameStatsKeyDown = false;
+
+	// GL_FRAGMENT_SHADER_INVOCATIONS query wrapped around the lit opaque pass, set by RunBenchmark to measure overdraw
+	unsigned _shadingQuery = 0;
+
+	// GL calls of the last frame, only counted once InstallGLCallCounters has run
+	GLCallCounts _glCalls;
+
+	Texture _whiteTexture;
+	std::unique_ptr<Sprite> _statsBar;
+
+	std::unique_ptr<Skybox> _skybox;
 	std::unique_ptr<Player> _player;
 	std::unique_ptr<Sprite> _lives;
 	std::unique_ptr<Sprite> _win;
@@ -59,11 +180,18 @@ private:
 	std::unique_ptr<Ball> _ball;
 	
 	std::unique_ptr<Brick> _brick;
-	std::unique_ptr<Brick> _brickLeft;
-	std::unique_ptr<Brick> _brickRight;
-	std::unique_ptr<Brick> _brickTop;
+
+	// the walls around the field, one baked mesh each, see BuildWall
+	std::unique_ptr<GameObject> _wallLeft;
+	std::unique_ptr<GameObject> _wallRight;
+	std::unique_ptr<GameObject> _wallTop;
 
 	glm::vec3 _lightPos = glm::vec3(30.0f, 30.0f, 30.0f);
 	glm::vec3 _lightColour = glm::vec3(0.8f, 0.9f, 0.8f);
 	GLfloat _lightRotation = -0.001f;
+
+	LaunchOptions _options;
+
+	unsigned _drawnObjects = 0;
+	unsigned _culledObjects = 0;
 };
\ No newline at end of file
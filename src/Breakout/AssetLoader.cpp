@@ -0,0 +1,216 @@
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include <glad/glad.h>
+
+AssetLoader::AssetLoader(unsigned threadCount)
+{
+	if (threadCount == 0)
+	{
+		// hardware_concurrency may be 0 when unknown, clamp before subtracting - at least one worker either way
+		threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	}
+
+	// needs GL, so it is asked here rather than on the workers
+	_s3tcSupported = Texture::IsS3tcSupported();
+
+	glCreateBuffers(1, &_pixelUnpackBuffer);
+
+	for (unsigned i = 0; i < threadCount; i++)
+	{
+		_workers.emplace_back(&AssetLoader::WorkerLoop, this);
+	}
+}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_jobAdded.notify_all();
+
+	for (auto& worker : _workers)
+	{
+		worker.join();
+	}
+
+	glDeleteBuffers(1, &_pixelUnpackBuffer);
+}
+
+void AssetLoader::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<Upload()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_jobAdded.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+
+			if (_stopping)
+			{
+				return;
+			}
+
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+
+		Upload upload = job();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_uploads.push_back(std::move(upload));
+		}
+
+		_uploadAdded.notify_one();
+	}
+}
+
+void AssetLoader::Submit(std::function<Upload()> job)
+{
+	if (_pending == 0)
+	{
+		_start = std::chrono::steady_clock::now();
+		_loaded = 0;
+	}
+
+	_pending++;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_jobs.push_back(std::move(job));
+	}
+
+	_jobAdded.notify_one();
+}
+
+void AssetLoader::LoadTexture(const Texture& texture, const std::string& fileName, const TextureImportSettings& settings)
+{
+	const bool s3tcSupported = _s3tcSupported;
+
+	Submit([this, texture, fileName, settings, s3tcSupported]()
+	{
+		auto image = std::make_shared<TextureImage>();
+		Texture::Decode(fileName, settings, s3tcSupported, *image);
+
+		Texture target = texture;
+		const TextureFilter filter = settings.filter;
+
+		return Upload([this, target, image, filter]() mutable
+		{
+			return UploadTexture(target, *image, filter);
+		});
+	});
+}
+
+void AssetLoader::LoadModel(Model& model, const std::string& path, std::function<void(Model&)> prepare)
+{
+	Model* target = &model;
+
+	Submit([target, path, prepare]()
+	{
+		// the worker fills a model of its own, the target is drawn from meanwhile and only changes on the GL thread
+		auto loaded = std::make_shared<Model>();
+		loaded->load(path);
+
+		if (prepare)
+		{
+			prepare(*loaded);
+		}
+
+		return Upload([target, loaded]()
+		{
+			target->takeMesh(std::move(*loaded));
+			target->setBuffers();
+
+			return target->packedVertices.size() * sizeof(PackedVertex) + target->indices.size() * (target->indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint));
+		});
+	});
+}
+
+size_t AssetLoader::UploadTexture(Texture& texture, const TextureImage& image, TextureFilter filter)
+{
+	const size_t size = image.GetByteSize();
+
+	if (size == 0)
+	{
+		texture.Upload(image, filter);
+		return 0;
+	}
+
+	// orphan the previous contents so the driver does not wait for the last upload to finish reading them
+	glNamedBufferData(_pixelUnpackBuffer, size, nullptr, GL_STREAM_DRAW);
+
+	auto mapped = static_cast<unsigned char*>(glMapNamedBufferRange(_pixelUnpackBuffer, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+	for (const auto& level : image.levels)
+	{
+		std::memcpy(mapped, level.data.data(), level.data.size());
+		mapped += level.data.size();
+	}
+
+	glUnmapNamedBuffer(_pixelUnpackBuffer);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelUnpackBuffer);
+	texture.Upload(image, filter, true);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	return size;
+}
+
+unsigned AssetLoader::Update(size_t byteBudget)
+{
+	size_t uploadedBytes = 0;
+
+	while (_pending > 0 && uploadedBytes < byteBudget)
+	{
+		Upload upload;
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			if (_uploads.empty())
+			{
+				break;
+			}
+
+			upload = std::move(_uploads.front());
+			_uploads.pop_front();
+		}
+
+		uploadedBytes += upload();
+
+		_pending--;
+		_loaded++;
+
+		if (_pending == 0)
+		{
+			const float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _start).count();
+			std::cout << "ASSETS::LOADED " << _loaded << " assets in " << milliseconds << " ms on " << _workers.size() << " threads" << std::endl;
+			std::cout << "TEXTURE::MEMORY " << Texture::GetTotalSourceBytes() / 1024 << " KB at source size -> "
+				<< Texture::GetTotalGpuBytes() / 1024 << " KB uploaded" << std::endl;
+		}
+	}
+
+	return _pending;
+}
+
+void AssetLoader::Finish()
+{
+	while (_pending > 0)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_uploadAdded.wait(lock, [this] { return !_uploads.empty(); });
+		}
+
+		Update(SIZE_MAX);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Texture.h"
+#include "models/Model.h"
+
+// Reads and decodes textures and models on a pool of worker threads. The GL side of every asset
+// (texture upload through a pixel unpack buffer, vertex and index buffers) is done by Update on the GL thread
+class AssetLoader
+{
+public:
+	// threadCount 0 uses one thread less than the hardware has, the GL thread keeps rendering
+	explicit AssetLoader(unsigned threadCount = 0);
+	~AssetLoader();
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	// the texture is a shared handle, it and every copy of it get the GL texture once Update uploads it
+	void LoadTexture(const Texture& texture, const std::string& fileName, const TextureImportSettings& settings = TextureImportSettings());
+
+	// prepare runs on the worker after loading, for CPU work like building LODs. It is given the worker's own copy of the
+	// model, which Update moves into model on the GL thread. The model must outlive the load
+	void LoadModel(Model& model, const std::string& path, std::function<void(Model&)> prepare = nullptr);
+
+	// GL thread: uploads finished assets until about byteBudget bytes went to the driver, returns the number still pending
+	unsigned Update(size_t byteBudget = 8 * 1024 * 1024);
+
+	// GL thread: waits for the workers and uploads everything
+	void Finish();
+
+	unsigned GetPending() const { return _pending; }
+
+private:
+	void WorkerLoop();
+
+	// runs on the GL thread, returns the number of bytes uploaded
+	typedef std::function<size_t()> Upload;
+
+	void Submit(std::function<Upload()> job);
+
+	size_t UploadTexture(Texture& texture, const TextureImage& image, TextureFilter filter);
+
+	std::vector<std::thread> _workers;
+
+	std::mutex _mutex;
+	std::condition_variable _jobAdded;
+	std::condition_variable _uploadAdded;
+
+	std::deque<std::function<Upload()>> _jobs;
+	std::deque<Upload> _uploads;
+	bool _stopping = false;
+
+	// submitted and not uploaded yet, only touched on the GL thread
+	unsigned _pending = 0;
+	unsigned _loaded = 0;
+	std::chrono::steady_clock::time_point _start;
+
+	bool _s3tcSupported = false;
+
+	// staging buffer for texture data, orphaned on every upload
+	unsigned _pixelUnpackBuffer = 0;
+};
@@ -0,0 +1,115 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+FrameStats::FrameStats(float hitchMilliseconds) : _frames(CAPACITY), _hitchMilliseconds(hitchMilliseconds)
+{
+}
+
+void FrameStats::Add(const FrameTimes& times)
+{
+	_frames[_next] = times;
+	_next = (_next + 1) % CAPACITY;
+
+	if (_count < CAPACITY)
+	{
+		_count++;
+	}
+	else
+	{
+		_firstFrame++;
+	}
+
+	if (times.total > _hitchMilliseconds)
+	{
+		_totalHitches++;
+	}
+}
+
+const FrameTimes& FrameStats::GetFrame(unsigned age) const
+{
+	return _frames[(_next + CAPACITY - 1 - age) % CAPACITY];
+}
+
+FrameStats::Summary FrameStats::Summarize(float FrameTimes::* field) const
+{
+	Summary summary = {};
+	summary.frames = _count;
+
+	if (_count == 0)
+	{
+		return summary;
+	}
+
+	std::vector<float> sorted;
+	sorted.reserve(_count);
+
+	for (unsigned age = 0; age < _count; age++)
+	{
+		const float time = GetFrame(age).*field;
+		sorted.push_back(time);
+
+		if (GetFrame(age).total > _hitchMilliseconds)
+		{
+			summary.hitches++;
+		}
+	}
+
+	std::sort(sorted.begin(), sorted.end());
+
+	// nearest rank
+	auto percentile = [&](float p)
+	{
+		const size_t rank = (size_t)std::ceil(p / 100.0f * sorted.size());
+		return sorted[std::max<size_t>(rank, 1) - 1];
+	};
+
+	summary.p50 = percentile(50.0f);
+	summary.p95 = percentile(95.0f);
+	summary.p99 = percentile(99.0f);
+	summary.max = sorted.back();
+
+	return summary;
+}
+
+bool FrameStats::WriteCsv(const std::string& path) const
+{
+	std::ofstream file(path);
+
+	if (!file)
+	{
+		std::cout << "ERROR::FRAME_STATS::CSV_NOT_WRITTEN " << path << std::endl;
+		return false;
+	}
+
+	file << "frame,update_ms,render_ms,swap_ms,total_ms\n";
+
+	for (unsigned i = 0; i < _count; i++)
+	{
+		const FrameTimes& times = GetFrame(_count - 1 - i);
+		file << _firstFrame + i << "," << times.update << "," << times.render << "," << times.swap << "," << times.total << "\n";
+	}
+
+	const struct { const char* name; float FrameTimes::* field; } fields[] =
+	{
+		{ "update", &FrameTimes::update },
+		{ "render", &FrameTimes::render },
+		{ "swap", &FrameTimes::swap },
+		{ "total", &FrameTimes::total }
+	};
+
+	file << "\nstat,p50_ms,p95_ms,p99_ms,max_ms\n";
+
+	for (const auto& entry : fields)
+	{
+		const Summary summary = Summarize(entry.field);
+		file << entry.name << "," << summary.p50 << "," << summary.p95 << "," << summary.p99 << "," << summary.max << "\n";
+	}
+
+	file << "\nhitches over " << _hitchMilliseconds << " ms," << _totalHitches << "\n";
+
+	return file.good();
+}
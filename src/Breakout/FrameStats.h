@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// CPU milliseconds spent in each part of one frame
+struct FrameTimes
+{
+	float update;
+	float render;
+	float swap;
+
+	// from the start of this frame to the start of the next
+	float total;
+};
+
+// Keeps the last CAPACITY frames in a ring buffer and reports percentiles over them
+class FrameStats
+{
+public:
+	static const unsigned CAPACITY = 4096;
+
+	struct Summary
+	{
+		float p50;
+		float p95;
+		float p99;
+		float max;
+
+		// frames in the ring slower than the hitch threshold
+		unsigned hitches;
+		unsigned frames;
+	};
+
+	// frames taking longer than hitchMilliseconds count as hitches, two missed 60 Hz vblanks by default
+	explicit FrameStats(float hitchMilliseconds = 33.3f);
+
+	void Add(const FrameTimes& times);
+
+	// percentiles of one field, e.g. Summarize(&FrameTimes::render)
+	Summary Summarize(float FrameTimes::* field = &FrameTimes::total) const;
+
+	unsigned GetCount() const { return _count; }
+
+	// age 0 is the latest frame
+	const FrameTimes& GetFrame(unsigned age) const;
+
+	float GetHitchMilliseconds() const { return _hitchMilliseconds; }
+
+	// every hitch since start up, not only the ones still in the ring
+	unsigned GetTotalHitches() const { return _totalHitches; }
+
+	// one row per frame still in the ring, oldest first, followed by the summaries
+	bool WriteCsv(const std::string& path) const;
+
+private:
+	std::vector<FrameTimes> _frames;
+	unsigned _next = 0;
+	unsigned _count = 0;
+
+	// frame number of the oldest frame in the ring
+	unsigned _firstFrame = 0;
+
+	float _hitchMilliseconds;
+	unsigned _totalHitches = 0;
+};
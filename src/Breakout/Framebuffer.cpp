@@ -0,0 +1,61 @@
+#include "Framebuffer.h"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+Framebuffer::Framebuffer(int width, int height) : _width(width), _height(height)
+{
+	glCreateRenderbuffers(1, &_colour);
+	glNamedRenderbufferStorage(_colour, GL_RGBA8, width, height);
+
+	glCreateRenderbuffers(1, &_depth);
+	glNamedRenderbufferStorage(_depth, GL_DEPTH_COMPONENT24, width, height);
+
+	glCreateFramebuffers(1, &_framebuffer);
+	glNamedFramebufferRenderbuffer(_framebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colour);
+	glNamedFramebufferRenderbuffer(_framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depth);
+}
+
+Framebuffer::~Framebuffer()
+{
+	glDeleteFramebuffers(1, &_framebuffer);
+	glDeleteRenderbuffers(1, &_colour);
+	glDeleteRenderbuffers(1, &_depth);
+}
+
+void Framebuffer::Bind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	glViewport(0, 0, _width, _height);
+}
+
+void Framebuffer::Unbind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool Framebuffer::IsComplete() const
+{
+	return glCheckNamedFramebufferStatus(_framebuffer, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+std::vector<unsigned char> Framebuffer::ReadPixels() const
+{
+	const size_t rowSize = (size_t)_width * 4;
+	std::vector<unsigned char> pixels(rowSize * _height);
+
+	glNamedFramebufferReadBuffer(_framebuffer, GL_COLOR_ATTACHMENT0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	// GL returns the bottom row first
+	for (int y = 0; y < _height / 2; y++)
+	{
+		std::swap_ranges(pixels.begin() + y * rowSize, pixels.begin() + (y + 1) * rowSize, pixels.begin() + (_height - 1 - y) * rowSize);
+	}
+
+	return pixels;
+}
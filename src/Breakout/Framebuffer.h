@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+// Offscreen render target with an RGBA8 colour and a 24-bit depth renderbuffer
+class Framebuffer
+{
+public:
+	Framebuffer(int width, int height);
+	~Framebuffer();
+
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	void Bind() const;
+	void Unbind() const;
+
+	// false if the driver rejected the attachments
+	bool IsComplete() const;
+
+	// colour attachment as RGBA8, rows from top to bottom
+	std::vector<unsigned char> ReadPixels() const;
+
+	int GetWidth() const { return _width; }
+	int GetHeight() const { return _height; }
+
+	unsigned GetID() const { return _framebuffer; }
+
+private:
+	unsigned _framebuffer = 0;
+	unsigned _colour = 0;
+	unsigned _depth = 0;
+
+	int _width;
+	int _height;
+};
@@ -0,0 +1,87 @@
+#include "Frustum.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define FRUSTUM_SSE
+#include <emmintrin.h>
+#endif
+
+void Frustum::Update(const glm::mat4& viewProjection)
+{
+	// rows of the matrix (glm is column major)
+	const glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	const glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	const glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	const glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	_planes[0] = row3 + row0;
+	_planes[1] = row3 - row0;
+	_planes[2] = row3 + row1;
+	_planes[3] = row3 - row1;
+	_planes[4] = row3 + row2;
+	_planes[5] = row3 - row2;
+
+	// normalize so that the plane equation gives the real distance
+	for (auto& plane : _planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+}
+
+bool Frustum::IsSphereVisible(glm::vec3 center, float radius) const
+{
+	for (const auto& plane : _planes)
+	{
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+unsigned Frustum::CullSpheres(const float* x, const float* y, const float* z, const float* radius, unsigned count, unsigned char* visible) const
+{
+	unsigned visibleCount = 0;
+	unsigned i = 0;
+
+#ifdef FRUSTUM_SSE
+	// four spheres against one plane per iteration
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 sx = _mm_loadu_ps(x + i);
+		const __m128 sy = _mm_loadu_ps(y + i);
+		const __m128 sz = _mm_loadu_ps(z + i);
+		const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		for (const auto& plane : _planes)
+		{
+			__m128 distance = _mm_mul_ps(sx, _mm_set1_ps(plane.x));
+			distance = _mm_add_ps(distance, _mm_mul_ps(sy, _mm_set1_ps(plane.y)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(sz, _mm_set1_ps(plane.z)));
+			distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+		}
+
+		const int mask = _mm_movemask_ps(inside);
+
+		for (unsigned j = 0; j < 4; j++)
+		{
+			visible[i + j] = (mask >> j) & 1;
+			visibleCount += visible[i + j];
+		}
+	}
+#endif
+
+	// remaining spheres
+	for (; i < count; i++)
+	{
+		visible[i] = IsSphereVisible(glm::vec3(x[i], y[i], z[i]), radius[i]) ? 1 : 0;
+		visibleCount += visible[i];
+	}
+
+	return visibleCount;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// The six clip planes of a camera, extracted from its combined projection * view matrix
+class Frustum
+{
+public:
+	void Update(const glm::mat4& viewProjection);
+
+	// returns true if the sphere is inside or intersects the frustum
+	bool IsSphereVisible(glm::vec3 center, float radius) const;
+
+	// tests a batch of spheres stored as separate x/y/z/radius arrays, four at a time.
+	// visible[i] is set to 1 for every sphere inside the frustum, 0 otherwise. Returns the number of visible spheres
+	unsigned CullSpheres(const float* x, const float* y, const float* z, const float* radius, unsigned count, unsigned char* visible) const;
+
+private:
+	// left, right, bottom, top, near, far - xyz is the normal pointing inwards, w the distance
+	glm::vec4 _planes[6];
+};
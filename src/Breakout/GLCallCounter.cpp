@@ -0,0 +1,358 @@
+#include "GLCallCounter.h"
+
+#include <map>
+#include <utility>
+
+#include <glad/glad.h>
+
+namespace
+{
+	bool installed = false;
+	GLCallCounts counts;
+
+	// what the wrappers have seen bound, keyed by target or by texture unit and target. Bindings made
+	// before InstallGLCallCounters are UNKNOWN, so the first bind after it is never counted as redundant
+	const GLuint UNKNOWN = ~0u;
+
+	GLuint currentProgram = UNKNOWN;
+	GLuint currentVertexArray = UNKNOWN;
+	GLuint activeTextureUnit = 0;
+	std::map<GLenum, GLuint> currentBuffers;
+	std::map<std::pair<GLuint, GLenum>, GLuint> currentTextures;
+
+	// the driver's functions
+	PFNGLDRAWARRAYSPROC drawArrays;
+	PFNGLDRAWARRAYSINSTANCEDPROC drawArraysInstanced;
+	PFNGLDRAWELEMENTSPROC drawElements;
+	PFNGLDRAWELEMENTSBASEVERTEXPROC drawElementsBaseVertex;
+	PFNGLDRAWELEMENTSINSTANCEDPROC drawElementsInstanced;
+	PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC drawElementsInstancedBaseVertex;
+	PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC drawElementsInstancedBaseVertexBaseInstance;
+	PFNGLDRAWELEMENTSINDIRECTPROC drawElementsIndirect;
+	PFNGLMULTIDRAWELEMENTSINDIRECTPROC multiDrawElementsIndirect;
+
+	PFNGLBINDBUFFERPROC bindBuffer;
+	PFNGLBINDVERTEXARRAYPROC bindVertexArray;
+	PFNGLACTIVETEXTUREPROC activeTexture;
+	PFNGLBINDTEXTUREPROC bindTexture;
+	PFNGLBINDTEXTUREUNITPROC bindTextureUnit;
+	PFNGLUSEPROGRAMPROC useProgram;
+
+	PFNGLDELETEBUFFERSPROC deleteBuffers;
+	PFNGLDELETEVERTEXARRAYSPROC deleteVertexArrays;
+	PFNGLDELETETEXTURESPROC deleteTextures;
+
+	PFNGLUNIFORM1IPROC uniform1i;
+	PFNGLUNIFORM1FPROC uniform1f;
+	PFNGLUNIFORM2FPROC uniform2f;
+	PFNGLUNIFORM3FPROC uniform3f;
+	PFNGLUNIFORM4FPROC uniform4f;
+	PFNGLUNIFORM1FVPROC uniform1fv;
+	PFNGLUNIFORM3FVPROC uniform3fv;
+	PFNGLUNIFORM4FVPROC uniform4fv;
+	PFNGLUNIFORMMATRIX3FVPROC uniformMatrix3fv;
+	PFNGLUNIFORMMATRIX4FVPROC uniformMatrix4fv;
+
+	void CountDraw(GLsizei vertices, GLsizei instances)
+	{
+		counts.drawCalls++;
+		counts.vertices += (uint64_t)vertices * (uint64_t)instances;
+	}
+
+	template <typename Key>
+	GLuint& Binding(std::map<Key, GLuint>& bindings, const Key& key)
+	{
+		return bindings.insert(std::make_pair(key, UNKNOWN)).first->second;
+	}
+
+	// true when the bind changes nothing
+	bool Track(GLuint& current, GLuint object)
+	{
+		const bool redundant = current == object;
+		current = object;
+
+		if (redundant)
+		{
+			counts.redundantBinds++;
+		}
+
+		return redundant;
+	}
+
+	void APIENTRY DrawArrays(GLenum mode, GLint first, GLsizei count)
+	{
+		CountDraw(count, 1);
+		drawArrays(mode, first, count);
+	}
+
+	void APIENTRY DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+	{
+		CountDraw(count, instancecount);
+		drawArraysInstanced(mode, first, count, instancecount);
+	}
+
+	void APIENTRY DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+	{
+		CountDraw(count, 1);
+		drawElements(mode, count, type, indices);
+	}
+
+	void APIENTRY DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+	{
+		CountDraw(count, 1);
+		drawElementsBaseVertex(mode, count, type, indices, basevertex);
+	}
+
+	void APIENTRY DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount)
+	{
+		CountDraw(count, instancecount);
+		drawElementsInstanced(mode, count, type, indices, instancecount);
+	}
+
+	void APIENTRY DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex)
+	{
+		CountDraw(count, instancecount);
+		drawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+	}
+
+	void APIENTRY DrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance)
+	{
+		CountDraw(count, instancecount);
+		drawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instancecount, basevertex, baseinstance);
+	}
+
+	// the index counts live in a GPU buffer, so only the draws are counted
+	void APIENTRY DrawElementsIndirect(GLenum mode, GLenum type, const void* indirect)
+	{
+		counts.drawCalls++;
+		drawElementsIndirect(mode, type, indirect);
+	}
+
+	void APIENTRY MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+	{
+		counts.drawCalls += drawcount;
+		multiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+	}
+
+	void APIENTRY BindBuffer(GLenum target, GLuint buffer)
+	{
+		counts.bufferBinds++;
+		Track(Binding(currentBuffers, target), buffer);
+		bindBuffer(target, buffer);
+	}
+
+	void APIENTRY BindVertexArray(GLuint array)
+	{
+		counts.vertexArrayBinds++;
+
+		// the element buffer binding belongs to the vertex array
+		if (!Track(currentVertexArray, array))
+		{
+			currentBuffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+		}
+
+		bindVertexArray(array);
+	}
+
+	void APIENTRY ActiveTexture(GLenum texture)
+	{
+		activeTextureUnit = texture - GL_TEXTURE0;
+		activeTexture(texture);
+	}
+
+	void APIENTRY BindTexture(GLenum target, GLuint texture)
+	{
+		counts.textureBinds++;
+		Track(Binding(currentTextures, std::make_pair(activeTextureUnit, target)), texture);
+		bindTexture(target, texture);
+	}
+
+	// the target comes from the texture itself, so DSA binds are tracked under target 0 of the unit
+	void APIENTRY BindTextureUnit(GLuint unit, GLuint texture)
+	{
+		counts.textureBinds++;
+		Track(Binding(currentTextures, std::make_pair(unit, (GLenum)0)), texture);
+		bindTextureUnit(unit, texture);
+	}
+
+	void APIENTRY UseProgram(GLuint program)
+	{
+		counts.programBinds++;
+		Track(currentProgram, program);
+		useProgram(program);
+	}
+
+	// deleting a bound object binds zero in its place
+	void APIENTRY DeleteBuffers(GLsizei n, const GLuint* buffers)
+	{
+		for (GLsizei i = 0; i < n; i++)
+		{
+			for (auto& binding : currentBuffers)
+			{
+				if (binding.second == buffers[i])
+				{
+					binding.second = 0;
+				}
+			}
+		}
+
+		deleteBuffers(n, buffers);
+	}
+
+	void APIENTRY DeleteVertexArrays(GLsizei n, const GLuint* arrays)
+	{
+		for (GLsizei i = 0; i < n; i++)
+		{
+			if (currentVertexArray == arrays[i])
+			{
+				currentVertexArray = 0;
+				currentBuffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+			}
+		}
+
+		deleteVertexArrays(n, arrays);
+	}
+
+	void APIENTRY DeleteTextures(GLsizei n, const GLuint* textures)
+	{
+		for (GLsizei i = 0; i < n; i++)
+		{
+			for (auto& binding : currentTextures)
+			{
+				if (binding.second == textures[i])
+				{
+					binding.second = 0;
+				}
+			}
+		}
+
+		deleteTextures(n, textures);
+	}
+
+	void APIENTRY Uniform1i(GLint location, GLint v0)
+	{
+		counts.uniformUploads++;
+		uniform1i(location, v0);
+	}
+
+	void APIENTRY Uniform1f(GLint location, GLfloat v0)
+	{
+		counts.uniformUploads++;
+		uniform1f(location, v0);
+	}
+
+	void APIENTRY Uniform2f(GLint location, GLfloat v0, GLfloat v1)
+	{
+		counts.uniformUploads++;
+		uniform2f(location, v0, v1);
+	}
+
+	void APIENTRY Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+	{
+		counts.uniformUploads++;
+		uniform3f(location, v0, v1, v2);
+	}
+
+	void APIENTRY Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+	{
+		counts.uniformUploads++;
+		uniform4f(location, v0, v1, v2, v3);
+	}
+
+	void APIENTRY Uniform1fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		counts.uniformUploads++;
+		uniform1fv(location, count, value);
+	}
+
+	void APIENTRY Uniform3fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		counts.uniformUploads++;
+		uniform3fv(location, count, value);
+	}
+
+	void APIENTRY Uniform4fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		counts.uniformUploads++;
+		uniform4fv(location, count, value);
+	}
+
+	void APIENTRY UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+	{
+		counts.uniformUploads++;
+		uniformMatrix3fv(location, count, transpose, value);
+	}
+
+	void APIENTRY UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+	{
+		counts.uniformUploads++;
+		uniformMatrix4fv(location, count, transpose, value);
+	}
+
+	// keeps the driver's function in original and puts the wrapper in its place, entry points the context lacks stay null
+	template <typename Function>
+	void Wrap(Function& gladPointer, Function& original, Function wrapper)
+	{
+		original = gladPointer;
+
+		if (original)
+		{
+			gladPointer = wrapper;
+		}
+	}
+}
+
+void InstallGLCallCounters()
+{
+	if (installed)
+	{
+		return;
+	}
+
+	Wrap(glad_glDrawArrays, drawArrays, DrawArrays);
+	Wrap(glad_glDrawArraysInstanced, drawArraysInstanced, DrawArraysInstanced);
+	Wrap(glad_glDrawElements, drawElements, DrawElements);
+	Wrap(glad_glDrawElementsBaseVertex, drawElementsBaseVertex, DrawElementsBaseVertex);
+	Wrap(glad_glDrawElementsInstanced, drawElementsInstanced, DrawElementsInstanced);
+	Wrap(glad_glDrawElementsInstancedBaseVertex, drawElementsInstancedBaseVertex, DrawElementsInstancedBaseVertex);
+	Wrap(glad_glDrawElementsInstancedBaseVertexBaseInstance, drawElementsInstancedBaseVertexBaseInstance, DrawElementsInstancedBaseVertexBaseInstance);
+	Wrap(glad_glDrawElementsIndirect, drawElementsIndirect, DrawElementsIndirect);
+	Wrap(glad_glMultiDrawElementsIndirect, multiDrawElementsIndirect, MultiDrawElementsIndirect);
+
+	Wrap(glad_glBindBuffer, bindBuffer, BindBuffer);
+	Wrap(glad_glBindVertexArray, bindVertexArray, BindVertexArray);
+	Wrap(glad_glActiveTexture, activeTexture, ActiveTexture);
+	Wrap(glad_glBindTexture, bindTexture, BindTexture);
+	Wrap(glad_glBindTextureUnit, bindTextureUnit, BindTextureUnit);
+	Wrap(glad_glUseProgram, useProgram, UseProgram);
+
+	Wrap(glad_glDeleteBuffers, deleteBuffers, DeleteBuffers);
+	Wrap(glad_glDeleteVertexArrays, deleteVertexArrays, DeleteVertexArrays);
+	Wrap(glad_glDeleteTextures, deleteTextures, DeleteTextures);
+
+	Wrap(glad_glUniform1i, uniform1i, Uniform1i);
+	Wrap(glad_glUniform1f, uniform1f, Uniform1f);
+	Wrap(glad_glUniform2f, uniform2f, Uniform2f);
+	Wrap(glad_glUniform3f, uniform3f, Uniform3f);
+	Wrap(glad_glUniform4f, uniform4f, Uniform4f);
+	Wrap(glad_glUniform1fv, uniform1fv, Uniform1fv);
+	Wrap(glad_glUniform3fv, uniform3fv, Uniform3fv);
+	Wrap(glad_glUniform4fv, uniform4fv, Uniform4fv);
+	Wrap(glad_glUniformMatrix3fv, uniformMatrix3fv, UniformMatrix3fv);
+	Wrap(glad_glUniformMatrix4fv, uniformMatrix4fv, UniformMatrix4fv);
+
+	installed = true;
+}
+
+bool AreGLCallCountersInstalled()
+{
+	return installed;
+}
+
+GLCallCounts TakeGLCallCounts()
+{
+	const GLCallCounts frame = counts;
+	counts = GLCallCounts();
+
+	return frame;
+}
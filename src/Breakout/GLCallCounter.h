@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// GL work submitted in one frame, counted by the wrappers InstallGLCallCounters puts around the glad entry points
+struct GLCallCounts
+{
+	unsigned drawCalls = 0;
+
+	// vertices, or indices for indexed draws, times the instance count
+	uint64_t vertices = 0;
+
+	unsigned bufferBinds = 0;
+	unsigned vertexArrayBinds = 0;
+	unsigned textureBinds = 0;
+	unsigned programBinds = 0;
+
+	unsigned uniformUploads = 0;
+
+	// binds of an object that was already bound to that target, also included in the bind counts above
+	unsigned redundantBinds = 0;
+
+	unsigned GetBinds() const { return bufferBinds + vertexArrayBinds + textureBinds + programBinds; }
+};
+
+// replaces the draw, bind and uniform function pointers loaded by gladLoadGLLoader with counting wrappers that
+// call the driver's functions. Call once on the GL thread after gladLoadGLLoader, calling it again does nothing
+void InstallGLCallCounters();
+
+bool AreGLCallCountersInstalled();
+
+// returns everything counted since the last call and starts counting again from zero
+GLCallCounts TakeGLCallCounts();
@@ -0,0 +1,203 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <glad/glad.h>
+
+// recorded events are capped so a long session cannot grow without bound
+const size_t MAX_TRACE_EVENTS = 1000000;
+
+GpuProfiler::GpuProfiler(unsigned latency) : _frames(std::max(1u, latency) + 1)
+{
+	_epoch = std::chrono::steady_clock::now();
+
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+
+	_gpuOffset = gpuNow - CpuNanoseconds();
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (auto& frame : _frames)
+	{
+		if (!frame.queries.empty())
+		{
+			glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+		}
+	}
+}
+
+int64_t GpuProfiler::CpuNanoseconds() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count();
+}
+
+void GpuProfiler::BeginFrame()
+{
+	if (_frameStarted)
+	{
+		_frameIndex++;
+	}
+
+	_frameStarted = true;
+	_openScopes.clear();
+
+	// the oldest slot is reused for this frame, its queries were issued latency frames ago
+	Frame& frame = _frames[_frameIndex % _frames.size()];
+	Resolve(frame);
+}
+
+unsigned GpuProfiler::NextQuery(Frame& frame)
+{
+	if (frame.usedQueries == frame.queries.size())
+	{
+		GLuint query;
+		glGenQueries(1, &query);
+		frame.queries.push_back(query);
+	}
+
+	return frame.queries[frame.usedQueries++];
+}
+
+void GpuProfiler::Begin(const char* name)
+{
+	Frame& frame = _frames[_frameIndex % _frames.size()];
+
+	Scope scope;
+	scope.name = name;
+	scope.depth = (unsigned)_openScopes.size();
+	scope.startQuery = NextQuery(frame);
+	scope.endQuery = 0;
+	scope.cpuStart = CpuNanoseconds();
+	scope.cpuEnd = scope.cpuStart;
+
+	glQueryCounter(scope.startQuery, GL_TIMESTAMP);
+
+	_openScopes.push_back((unsigned)frame.scopes.size());
+	frame.scopes.push_back(scope);
+}
+
+void GpuProfiler::End()
+{
+	if (_openScopes.empty())
+	{
+		return;
+	}
+
+	Frame& frame = _frames[_frameIndex % _frames.size()];
+	Scope& scope = frame.scopes[_openScopes.back()];
+	_openScopes.pop_back();
+
+	scope.endQuery = NextQuery(frame);
+	scope.cpuEnd = CpuNanoseconds();
+
+	glQueryCounter(scope.endQuery, GL_TIMESTAMP);
+}
+
+void GpuProfiler::Resolve(Frame& frame)
+{
+	if (!frame.scopes.empty())
+	{
+		_resolvedFrames++;
+	}
+
+	for (const auto& scope : frame.scopes)
+	{
+		// left open at the end of a frame
+		if (scope.endQuery == 0)
+		{
+			continue;
+		}
+
+		// only waits when the GPU is more than latency frames behind
+		GLuint64 gpuStart = 0;
+		GLuint64 gpuEnd = 0;
+		glGetQueryObjectui64v(scope.startQuery, GL_QUERY_RESULT, &gpuStart);
+		glGetQueryObjectui64v(scope.endQuery, GL_QUERY_RESULT, &gpuEnd);
+
+		if (_events.size() + 2 > MAX_TRACE_EVENTS)
+		{
+			continue;
+		}
+
+		_events.push_back({ scope.name, scope.depth, false, scope.cpuStart / 1000.0, (scope.cpuEnd - scope.cpuStart) / 1000.0 });
+		_events.push_back({ scope.name, scope.depth, true, ((int64_t)gpuStart - _gpuOffset) / 1000.0, ((int64_t)gpuEnd - (int64_t)gpuStart) / 1000.0 });
+	}
+
+	frame.scopes.clear();
+	frame.usedQueries = 0;
+}
+
+void GpuProfiler::Flush()
+{
+	// oldest first, so events stay in frame order
+	for (unsigned i = 1; i <= _frames.size(); i++)
+	{
+		Resolve(_frames[(_frameIndex + i) % _frames.size()]);
+	}
+}
+
+bool GpuProfiler::WriteTrace(const std::string& path)
+{
+	Flush();
+
+	std::ofstream file(path);
+
+	if (!file)
+	{
+		std::cout << "ERROR::PROFILER::TRACE_NOT_WRITTEN " << path << std::endl;
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+	for (const auto& event : _events)
+	{
+		file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1)
+			<< ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}";
+	}
+
+	file << "\n]}\n";
+
+	std::cout << "PROFILER::TRACE " << _events.size() / 2 << " scopes over " << _resolvedFrames << " frames written to " << path << std::endl;
+
+	return file.good();
+}
+
+void GpuProfiler::PrintSummary() const
+{
+	std::vector<const char*> names;
+	std::vector<double> cpuTotals;
+	std::vector<double> gpuTotals;
+
+	for (const auto& event : _events)
+	{
+		auto found = std::find_if(names.begin(), names.end(), [&](const char* name) { return std::string(name) == event.name; });
+		const size_t index = found - names.begin();
+
+		if (found == names.end())
+		{
+			names.push_back(event.name);
+			cpuTotals.push_back(0.0);
+			gpuTotals.push_back(0.0);
+		}
+
+		(event.gpu ? gpuTotals : cpuTotals)[index] += event.duration;
+	}
+
+	const double frames = std::max(1u, _resolvedFrames);
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		std::cout << "PROFILER::" << names[i] << " cpu " << cpuTotals[i] / 1000.0 / frames << " ms, gpu " << gpuTotals[i] / 1000.0 / frames << " ms" << std::endl;
+	}
+}
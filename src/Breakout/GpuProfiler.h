@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Times named scopes of a frame on the CPU and, through GL_TIMESTAMP queries, on the GPU.
+// Query results are read back latency frames later so the CPU does not wait for the GPU,
+// and everything recorded can be written as a chrome://tracing / Perfetto JSON file
+class GpuProfiler
+{
+public:
+	explicit GpuProfiler(unsigned latency = 4);
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	// starts a new frame and collects the results of the frame recorded latency frames ago
+	void BeginFrame();
+
+	// scopes nest, name must stay valid until the results are read
+	void Begin(const char* name);
+	void End();
+
+	// waits for every query still in flight
+	void Flush();
+
+	// CPU and GPU scopes on two tracks of one process, timestamps in microseconds
+	bool WriteTrace(const std::string& path);
+
+	// average GPU milliseconds per frame for every scope name, in first seen order
+	void PrintSummary() const;
+
+private:
+	struct Scope
+	{
+		const char* name;
+		unsigned depth;
+
+		unsigned startQuery;
+		unsigned endQuery;
+
+		int64_t cpuStart;
+		int64_t cpuEnd;
+	};
+
+	struct Frame
+	{
+		std::vector<Scope> scopes;
+		std::vector<unsigned> queries;
+		unsigned usedQueries = 0;
+	};
+
+	struct Event
+	{
+		const char* name;
+		unsigned depth;
+		bool gpu;
+
+		// microseconds on the CPU clock
+		double start;
+		double duration;
+	};
+
+	unsigned NextQuery(Frame& frame);
+	void Resolve(Frame& frame);
+
+	int64_t CpuNanoseconds() const;
+
+	std::vector<Frame> _frames;
+	unsigned _frameIndex = 0;
+	bool _frameStarted = false;
+
+	std::vector<unsigned> _openScopes;
+
+	std::vector<Event> _events;
+	unsigned _resolvedFrames = 0;
+
+	std::chrono::steady_clock::time_point _epoch;
+
+	// GL_TIMESTAMP minus the CPU clock, both in nanoseconds, measured once at start up
+	int64_t _gpuOffset = 0;
+};
+
+// Begin in the constructor, End in the destructor. Does nothing without a profiler
+class ProfileScope
+{
+public:
+	ProfileScope(GpuProfiler* profiler, const char* name) : _profiler(profiler)
+	{
+		if (_profiler)
+		{
+			_profiler->Begin(name);
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (_profiler)
+		{
+			_profiler->End();
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	GpuProfiler* _profiler;
+};
@@ -0,0 +1,119 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(unsigned threadCount)
+	: _nextChunk(0), _doneChunks(0)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	}
+
+	for (unsigned i = 0; i < threadCount; i++)
+	{
+		_workers.emplace_back(&JobSystem::WorkerLoop, this);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_jobAdded.notify_all();
+
+	for (auto& worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::ParallelFor(unsigned count, unsigned chunkSize, const Job& job)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	chunkSize = std::max(chunkSize, 1u);
+
+	// waking the workers costs more than a single chunk
+	if (count <= chunkSize || _workers.empty())
+	{
+		job(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_job = &job;
+		_count = count;
+		_chunkSize = chunkSize;
+		_chunkCount = (count + chunkSize - 1) / chunkSize;
+		_nextChunk = 0;
+		_doneChunks = 0;
+		_generation++;
+	}
+
+	_jobAdded.notify_all();
+
+	RunChunks();
+
+	// the job lives on the caller's stack, no worker may still hold it when this returns
+	std::unique_lock<std::mutex> lock(_mutex);
+	_jobDone.wait(lock, [this]() { return _doneChunks == _chunkCount && _busyWorkers == 0; });
+
+	_job = nullptr;
+}
+
+void JobSystem::RunChunks()
+{
+	for (;;)
+	{
+		const unsigned chunk = _nextChunk++;
+
+		if (chunk >= _chunkCount)
+		{
+			return;
+		}
+
+		const unsigned begin = chunk * _chunkSize;
+		(*_job)(begin, std::min(begin + _chunkSize, _count));
+
+		_doneChunks++;
+	}
+}
+
+void JobSystem::WorkerLoop()
+{
+	unsigned generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_jobAdded.wait(lock, [this, generation]() { return _stopping || (_generation != generation && _job); });
+
+			if (_stopping)
+			{
+				return;
+			}
+
+			generation = _generation;
+			_busyWorkers++;
+		}
+
+		RunChunks();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_busyWorkers--;
+		}
+
+		_jobDone.notify_one();
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A pool of worker threads for splitting per-frame CPU work into chunks. The calling thread
+// works on the chunks too and only returns once all of them are done, so the jobs may freely
+// read and write anything the caller owns as long as no two chunks touch the same data
+class JobSystem
+{
+public:
+	// threadCount 0 uses one thread less than the hardware has, the calling thread is the last one
+	explicit JobSystem(unsigned threadCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	typedef std::function<void(unsigned begin, unsigned end)> Job;
+
+	// runs job over [0, count) in chunks of chunkSize, on the calling thread alone when there is only one chunk
+	void ParallelFor(unsigned count, unsigned chunkSize, const Job& job);
+
+	// workers plus the calling thread
+	unsigned GetThreadCount() const { return (unsigned)_workers.size() + 1; }
+
+private:
+	void WorkerLoop();
+
+	// takes chunks of the current job until there are none left
+	void RunChunks();
+
+	std::vector<std::thread> _workers;
+
+	std::mutex _mutex;
+	std::condition_variable _jobAdded;
+	std::condition_variable _jobDone;
+
+	// the job of the ParallelFor in progress, only changed while no worker is busy with it
+	const Job* _job = nullptr;
+	unsigned _count = 0;
+	unsigned _chunkSize = 0;
+	unsigned _chunkCount = 0;
+
+	std::atomic<unsigned> _nextChunk;
+	std::atomic<unsigned> _doneChunks;
+
+	// bumped by every ParallelFor so each worker joins a job once
+	unsigned _generation = 0;
+	unsigned _busyWorkers = 0;
+
+	bool _stopping = false;
+};
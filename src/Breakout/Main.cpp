@@ -1,9 +1,63 @@
 #include "Application.h"
 
-int main()
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
 {
+    LaunchOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--lod-report") == 0)
+        {
+            options.lodReport = true;
+        }
+        else if (std::strcmp(argv[i], "--ball-mesh") == 0)
+        {
+            options.ballMesh = true;
+        }
+        else if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            options.headless = true;
+        }
+        else if (std::strcmp(argv[i], "--headless-context") == 0 && i + 1 < argc)
+        {
+            i++;
+
+            if (std::strcmp(argv[i], "egl") == 0)
+            {
+                options.headlessContext = HeadlessContext::EGL;
+            }
+            else if (std::strcmp(argv[i], "osmesa") == 0)
+            {
+                options.headlessContext = HeadlessContext::OSMesa;
+            }
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            options.benchmarkFrames = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--dump-frames") == 0 && i + 1 < argc)
+        {
+            options.dumpFrameInterval = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+        {
+            options.profileTrace = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--depth-prepass") == 0)
+        {
+            options.depthPrepass = true;
+        }
+        else if (std::strcmp(argv[i], "--lights") == 0 && i + 1 < argc)
+        {
+            options.extraLights = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+
     Application app;
-    app.Run();
+    app.Run(options);
 
     return 0;
 }
\ No newline at end of file
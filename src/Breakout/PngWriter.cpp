@@ -0,0 +1,127 @@
+#include "PngWriter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+static uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+{
+	static uint32_t table[256];
+	static bool tableReady = false;
+
+	if (!tableReady)
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t value = i;
+
+			for (int bit = 0; bit < 8; bit++)
+			{
+				value = value & 1 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+			}
+
+			table[i] = value;
+		}
+
+		tableReady = true;
+	}
+
+	crc = ~crc;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+static void PutU32(std::vector<unsigned char>& out, uint32_t value)
+{
+	out.push_back((unsigned char)(value >> 24));
+	out.push_back((unsigned char)(value >> 16));
+	out.push_back((unsigned char)(value >> 8));
+	out.push_back((unsigned char)value);
+}
+
+static void WriteChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data)
+{
+	std::vector<unsigned char> chunk;
+	PutU32(chunk, (uint32_t)data.size());
+	chunk.insert(chunk.end(), type, type + 4);
+	chunk.insert(chunk.end(), data.begin(), data.end());
+
+	// the CRC covers the type and the data, not the length
+	PutU32(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+
+	file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+bool WritePng(const std::string& path, int width, int height, const unsigned char* rgba)
+{
+	std::ofstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	// 8 bits per channel, colour type 6 (RGBA), no interlacing
+	std::vector<unsigned char> header;
+	PutU32(header, width);
+	PutU32(header, height);
+	header.insert(header.end(), { 8, 6, 0, 0, 0 });
+	WriteChunk(file, "IHDR", header);
+
+	// every row starts with filter type 0
+	const size_t rowSize = (size_t)width * 4;
+	std::vector<unsigned char> raw;
+	raw.reserve((rowSize + 1) * height);
+
+	for (int y = 0; y < height; y++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), rgba + y * rowSize, rgba + (y + 1) * rowSize);
+	}
+
+	// zlib stream made of stored deflate blocks of at most 65535 bytes
+	std::vector<unsigned char> data = { 0x78, 0x01 };
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+
+	for (size_t offset = 0; offset < raw.size() || offset == 0; )
+	{
+		const size_t size = std::min<size_t>(65535, raw.size() - offset);
+		const bool last = offset + size == raw.size();
+
+		data.push_back(last ? 1 : 0);
+		data.push_back((unsigned char)size);
+		data.push_back((unsigned char)(size >> 8));
+		data.push_back((unsigned char)~size);
+		data.push_back((unsigned char)(~size >> 8));
+		data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + size);
+
+		for (size_t i = offset; i < offset + size; i++)
+		{
+			adlerA = (adlerA + raw[i]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+
+		offset += size;
+
+		if (last)
+		{
+			break;
+		}
+	}
+
+	PutU32(data, (adlerB << 16) | adlerA);
+	WriteChunk(file, "IDAT", data);
+	WriteChunk(file, "IEND", {});
+
+	return file.good();
+}
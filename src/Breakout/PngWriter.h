@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// Writes an 8-bit RGBA image as a PNG. The image data is stored without compression,
+// which keeps the writer small - it is only used for benchmark frame dumps
+bool WritePng(const std::string& path, int width, int height, const unsigned char* rgba);
@@ -0,0 +1,155 @@
+#include "RenderState.h"
+
+namespace
+{
+	// not a valid object name or enum, so the first call after Invalidate always differs
+	const GLuint UNKNOWN = ~0u;
+}
+
+// the defaults of a new context
+GLuint RenderState::_program = 0;
+GLuint RenderState::_vertexArray = 0;
+GLuint RenderState::_textures[RenderState::TEXTURE_UNITS] = {};
+
+int RenderState::_blend = 0;
+int RenderState::_depthTest = 0;
+int RenderState::_depthMask = 1;
+int RenderState::_colourMask = 1;
+
+GLenum RenderState::_blendSource = GL_ONE;
+GLenum RenderState::_blendDestination = GL_ZERO;
+GLenum RenderState::_depthFunc = GL_LESS;
+
+unsigned RenderState::_changes = 0;
+unsigned RenderState::_elided = 0;
+
+template <typename T>
+bool RenderState::Change(T& current, T value)
+{
+	if (current == value)
+	{
+		_elided++;
+		return false;
+	}
+
+	current = value;
+	_changes++;
+
+	return true;
+}
+
+void RenderState::UseProgram(GLuint program)
+{
+	if (Change(_program, program))
+	{
+		glUseProgram(program);
+	}
+}
+
+void RenderState::BindVertexArray(GLuint vertexArray)
+{
+	if (Change(_vertexArray, vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+	}
+}
+
+void RenderState::BindTexture(unsigned unit, GLuint texture)
+{
+	// units past the cache are rare enough to always bind
+	if (unit >= TEXTURE_UNITS)
+	{
+		glBindTextureUnit(unit, texture);
+		return;
+	}
+
+	if (Change(_textures[unit], texture))
+	{
+		glBindTextureUnit(unit, texture);
+	}
+}
+
+void RenderState::SetBlend(bool enabled)
+{
+	if (Change(_blend, enabled ? 1 : 0))
+	{
+		enabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+	}
+}
+
+void RenderState::SetBlendFunc(GLenum source, GLenum destination)
+{
+	// counted as one change, both factors are set by the same call
+	if (_blendSource == source && _blendDestination == destination)
+	{
+		_elided++;
+		return;
+	}
+
+	_blendSource = source;
+	_blendDestination = destination;
+	_changes++;
+
+	glBlendFunc(source, destination);
+}
+
+void RenderState::SetDepthTest(bool enabled)
+{
+	if (Change(_depthTest, enabled ? 1 : 0))
+	{
+		enabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+	}
+}
+
+void RenderState::SetDepthFunc(GLenum function)
+{
+	if (Change(_depthFunc, function))
+	{
+		glDepthFunc(function);
+	}
+}
+
+void RenderState::SetDepthMask(bool enabled)
+{
+	if (Change(_depthMask, enabled ? 1 : 0))
+	{
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void RenderState::SetColourMask(bool enabled)
+{
+	if (Change(_colourMask, enabled ? 1 : 0))
+	{
+		const GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+		glColorMask(mask, mask, mask, mask);
+	}
+}
+
+void RenderState::OnVertexArrayDeleted(GLuint vertexArray)
+{
+	if (_vertexArray == vertexArray)
+	{
+		_vertexArray = UNKNOWN;
+	}
+}
+
+void RenderState::Invalidate()
+{
+	_program = UNKNOWN;
+	_vertexArray = UNKNOWN;
+
+	for (auto& texture : _textures)
+	{
+		texture = UNKNOWN;
+	}
+
+	_blend = -1;
+	_depthTest = -1;
+	_depthMask = -1;
+	_colourMask = -1;
+
+	_blendSource = UNKNOWN;
+	_blendDestination = UNKNOWN;
+	_depthFunc = UNKNOWN;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Remembers the GL state last set through it - program, vertex array, texture per unit, blending, depth and colour writes -
+// and drops calls that would set what is already current, so the driver only sees real state changes.
+// Every bind of these objects must go through here, or the cache goes stale until Invalidate is called.
+// Textures are bound with glBindTextureUnit, which leaves the active texture unit on GL_TEXTURE0
+class RenderState
+{
+public:
+	static const unsigned TEXTURE_UNITS = 16;
+
+	static void UseProgram(GLuint program);
+	static void BindVertexArray(GLuint vertexArray);
+	static void BindTexture(unsigned unit, GLuint texture);
+
+	static void SetBlend(bool enabled);
+	static void SetBlendFunc(GLenum source, GLenum destination);
+	static void SetDepthTest(bool enabled);
+	static void SetDepthFunc(GLenum function);
+	static void SetDepthMask(bool enabled);
+
+	// all four colour channels at once, off while only depth is drawn
+	static void SetColourMask(bool enabled);
+
+	// a deleted object's name can be handed out again, so its binding is forgotten
+	static void OnVertexArrayDeleted(GLuint vertexArray);
+
+	// forget everything, the next call of each kind always reaches GL
+	static void Invalidate();
+
+	// calls that reached GL and calls that were dropped since start up
+	static unsigned GetChanges() { return _changes; }
+	static unsigned GetElided() { return _elided; }
+
+private:
+	// true when value differs from current, which then becomes value
+	template <typename T>
+	static bool Change(T& current, T value);
+
+	static GLuint _program;
+	static GLuint _vertexArray;
+	static GLuint _textures[TEXTURE_UNITS];
+
+	// -1 unknown, 0 disabled, 1 enabled
+	static int _blend;
+	static int _depthTest;
+	static int _depthMask;
+	static int _colourMask;
+
+	static GLenum _blendSource;
+	static GLenum _blendDestination;
+	static GLenum _depthFunc;
+
+	static unsigned _changes;
+	static unsigned _elided;
+};
@@ -1,101 +1,282 @@
 #include "Shader.h"
 
+#include <chrono>
+#include <iterator>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
 #include <glm/gtc/type_ptr.hpp>
 
+#include "RenderState.h"
+
+bool Shader::parallelCompile = false;
+
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
 {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-	
+    const auto start = std::chrono::steady_clock::now();
+
+    _name = vertexPath;
+
+    Build({ { GL_VERTEX_SHADER, ReadSource(vertexPath) }, { GL_FRAGMENT_SHADER, ReadSource(fragmentPath) } });
+
+    // time blocked here, Finalize adds its own share
+    buildMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Shader::Shader(const char* computePath)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    _name = computePath;
+
+    Build({ { GL_COMPUTE_SHADER, ReadSource(computePath) } });
+
+    buildMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string Shader::ReadSource(const char* path)
+{
+    std::ifstream shaderFile;
+
     // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	
+    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
     try
     {
-        // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-    	
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-    	
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-    	
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        shaderFile.open(path);
+        std::stringstream shaderStream;
+
+        // read file's buffer contents into the stream
+        shaderStream << shaderFile.rdbuf();
+        shaderFile.close();
+
+        return shaderStream.str();
     }
     catch (std::ifstream::failure e)
     {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+    }
+
+    return std::string();
+}
+
+void Shader::Build(const Sources& sources)
+{
+    _cachePath = GetCachePath(sources);
+
+    fromCache = LoadBinary(_cachePath);
+
+    if (!fromCache)
+    {
+        Submit(sources);
     }
+}
 
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
+std::string Shader::GetCachePath(const Sources& sources)
+{
+    const auto vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+    const auto renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const auto version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
 
-    const auto vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    std::string key;
 
-    glShaderSource(vertexShader, 1, &vShaderCode, nullptr);
+    for (const auto& source : sources)
+    {
+        key += source.second + '\0';
+    }
 
-    glCompileShader(vertexShader);
+    // a new driver or an edited source gets a new file
+    key += std::string(vendor ? vendor : "") + '\0' + (renderer ? renderer : "") + '\0' + (version ? version : "");
 
-    int  success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    // FNV-1a 64
+    unsigned long long hash = 14695981039346656037ull;
 
-    if (!success)
+    for (const unsigned char c : key)
+    {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+
+    std::stringstream path;
+    path << "cache/shader_" << std::hex << hash << ".bin";
+
+    return path.str();
+}
+
+bool Shader::LoadBinary(const std::string& cachePath)
+{
+    std::ifstream file(cachePath, std::ios::binary);
+
+    if (!file)
     {
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        return false;
     }
 
-    const auto fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    GLenum format = 0;
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
 
-    glShaderSource(fragmentShader, 1, &fShaderCode, nullptr);
+    const std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
 
-    glCompileShader(fragmentShader);
+    if (binary.empty())
+    {
+        return false;
+    }
 
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    ID = glCreateProgram();
+    glProgramBinary(ID, format, binary.data(), (GLsizei)binary.size());
+
+    int success;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
 
+    // the driver may reject binaries from another build of itself - compile from source instead
     if (!success)
     {
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+        glDeleteProgram(ID);
+        return false;
+    }
+
+    return true;
+}
+
+void Shader::SaveBinary(const std::string& cachePath) const
+{
+    int binaryLength = 0;
+    glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+
+    if (binaryLength <= 0)
+    {
+        return;
+    }
+
+    std::vector<char> binary(binaryLength);
+    GLenum format = 0;
+    glGetProgramBinary(ID, binaryLength, nullptr, &format, binary.data());
+
+#ifdef _WIN32
+    _mkdir("cache");
+#else
+    mkdir("cache", 0755);
+#endif
+
+    std::ofstream file(cachePath, std::ios::binary);
+
+    if (!file)
+    {
+        std::cout << "ERROR::SHADER::CACHE_NOT_WRITTEN " << cachePath << std::endl;
+        return;
+    }
+
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(binary.data(), binary.size());
+}
+
+void Shader::Submit(const Sources& sources)
+{
+    // no status queries here - they would wait for the compiler
+    for (const auto& source : sources)
+    {
+        const char* code = source.second.c_str();
+
+        const unsigned shader = glCreateShader(source.first);
+        glShaderSource(shader, 1, &code, nullptr);
+        glCompileShader(shader);
+
+        _stages.push_back({ source.first, shader });
     }
 
     ID = glCreateProgram();
 
-    glAttachShader(ID, vertexShader);
-    glAttachShader(ID, fragmentShader);
+    // ask the driver to keep the binary around for SaveBinary
+    glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    for (const auto& stage : _stages)
+    {
+        glAttachShader(ID, stage.second);
+    }
+
     glLinkProgram(ID);
+}
 
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+bool Shader::IsReady() const
+{
+    if (fromCache || _finalized || !parallelCompile)
+    {
+        return true;
+    }
 
-    if (!success)
+    int completed = 0;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &completed);
+
+    return completed != 0;
+}
+
+void Shader::Finalize()
+{
+    if (_finalized)
     {
-        glGetProgramInfoLog(ID, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::LINK_FAILED\n" << infoLog << std::endl;
+        return;
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    _finalized = true;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (!fromCache)
+    {
+        int  success;
+        char infoLog[512];
+
+        for (const auto& stage : _stages)
+        {
+            glGetShaderiv(stage.second, GL_COMPILE_STATUS, &success);
+
+            if (!success)
+            {
+                const char* type = stage.first == GL_VERTEX_SHADER ? "VERTEX" : stage.first == GL_FRAGMENT_SHADER ? "FRAGMENT" : "COMPUTE";
+
+                glGetShaderInfoLog(stage.second, 512, nullptr, infoLog);
+                std::cout << "ERROR::SHADER::" << type << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+            }
+        }
+
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+
+        if (!success)
+        {
+            glGetProgramInfoLog(ID, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::LINK_FAILED\n" << infoLog << std::endl;
+        }
+
+        for (const auto& stage : _stages)
+        {
+            glDeleteShader(stage.second);
+        }
+
+        _stages.clear();
+
+        if (success)
+        {
+            SaveBinary(_cachePath);
+        }
+    }
+
+    buildMilliseconds += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "SHADER::" << _name << (fromCache ? " loaded from cache in " : " compiled in ") << buildMilliseconds << " ms" << std::endl;
 }
 
 void Shader::use()
 {
-    glUseProgram(ID);
+    RenderState::UseProgram(ID);
 }
 
 void Shader::unuse()
 {
-    glUseProgram(0);
+    RenderState::UseProgram(0);
 }
 
 void Shader::setBool(const std::string& name, bool value) const
@@ -113,12 +294,24 @@ void Shader::setFloat(const std::string& name, float value) const
     glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
 }
 
+void Shader::setFloat2(const std::string& name, glm::vec2 value) const
+{
+    const auto transformLoc = glGetUniformLocation(ID, name.c_str());
+    glUniform2f(transformLoc, value.x, value.y);
+}
+
 void Shader::setFloat3(const std::string& name, glm::vec3 value) const
 {
     const auto transformLoc = glGetUniformLocation(ID, name.c_str());
     glUniform3f(transformLoc, value.x, value.y, value.z);
 }
 
+void Shader::setFloatMat3(const std::string& name, glm::mat3 value) const
+{
+    const auto transformLoc = glGetUniformLocation(ID, name.c_str());
+    glUniformMatrix3fv(transformLoc, 1, GL_FALSE, glm::value_ptr(value));
+}
+
 void Shader::setFloatMat4(const std::string& name, glm::mat4 value) const
 {
     const auto transformLoc = glGetUniformLocation(ID, name.c_str());
@@ -4,20 +4,46 @@
 #include <glad/glad.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <glm/fwd.hpp>
 
+// GL_KHR_parallel_shader_compile is not part of the generated loader
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 class Shader
 {
 public:
     // the program ID
     unsigned int ID;
 
-    // constructor reads and builds the shader
+    // true when the program came from the binary cache instead of being compiled
+    bool fromCache = false;
+
+    // time spent reading, compiling/loading and linking
+    float buildMilliseconds = 0.0f;
+
+    // set when the driver compiles on its own threads (GL_KHR_parallel_shader_compile)
+    static bool parallelCompile;
+
+    // constructor reads the sources and submits them for compiling and linking without waiting for the result.
+    // Construct every shader first and call Finalize later, so the driver compiles them while other work runs
     Shader(const char* vertexPath, const char* fragmentPath);
 
+    // a compute program, started with glDispatchCompute after use
+    explicit Shader(const char* computePath);
+
+    // true once the driver has finished compiling and linking, Finalize will not block then
+    bool IsReady() const;
+
+    // checks the compile and link status, reports errors and stores the program in the cache. Must be called before use
+    void Finalize();
+
     // use/activate the shader
     void use();
 
@@ -28,8 +54,36 @@ public:
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
     void setFloat(const std::string& name, float value) const;
+    void setFloat2(const std::string& name, glm::vec2 value) const;
     void setFloat3(const std::string& name, glm::vec3 value) const;
+    void setFloatMat3(const std::string& name, glm::mat3 value) const;
     void setFloatMat4(const std::string& name, glm::mat4 value) const;
+
+private:
+    // shader type and source of every stage
+    typedef std::vector<std::pair<GLenum, std::string>> Sources;
+
+    // reads the whole file, reports and returns an empty string when it cannot
+    static std::string ReadSource(const char* path);
+
+    // linked programs are kept in cache/ keyed by the sources and the driver that built them
+    static std::string GetCachePath(const Sources& sources);
+
+    // loads the program from the cache, or submits the sources when it is not there
+    void Build(const Sources& sources);
+
+    bool LoadBinary(const std::string& cachePath);
+    void SaveBinary(const std::string& cachePath) const;
+
+    void Submit(const Sources& sources);
+
+    std::string _name;
+    std::string _cachePath;
+
+    // shader type and shader object of every stage, deleted by Finalize
+    std::vector<std::pair<GLenum, unsigned>> _stages;
+
+    bool _finalized = false;
 };
 
-#endif
\ No newline at end of file
+#endif
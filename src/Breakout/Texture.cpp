@@ -1,58 +1,433 @@
 #include "Texture.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <glad/glad.h>
 
+#include "RenderState.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image/stb_image.h>
 
-unsigned int Texture::Load(const std::string& fileName)
+// GL_EXT_texture_compression_s3tc is not part of the generated loader
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+static bool IsExtensionSupported(const char* name)
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (std::strcmp(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)), name) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// cuts the six faces out of a horizontal cross laid out as the old skybox cube.obj mapped it:
+// -X +Z +X -Z across the second row, +Y above and -Y below +X, both turned a quarter so they meet +X
+static std::vector<TextureLevel> SplitCubemapCross(const TextureLevel& cross, int channels)
+{
+    struct FaceCell
+    {
+        unsigned column;
+        unsigned row;
+
+        // 0 as is, 1 a quarter turn clockwise, 2 a quarter turn anticlockwise
+        int turn;
+    };
+
+    // in GL face order +X -X +Y -Y +Z -Z
+    const FaceCell cells[6] = { {2, 1, 0}, {0, 1, 0}, {2, 0, 1}, {2, 2, 2}, {1, 1, 0}, {3, 1, 0} };
+
+    const unsigned size = cross.width / 4;
+    std::vector<TextureLevel> faces(6);
+
+    for (unsigned face = 0; face < 6; face++)
+    {
+        const FaceCell& cell = cells[face];
+
+        faces[face].width = size;
+        faces[face].height = size;
+        faces[face].data.resize((size_t)size * size * channels);
+
+        for (unsigned t = 0; t < size; t++)
+        {
+            for (unsigned s = 0; s < size; s++)
+            {
+                unsigned x = s;
+                unsigned y = t;
+
+                if (cell.turn == 1)
+                {
+                    x = size - 1 - t;
+                    y = s;
+                }
+                else if (cell.turn == 2)
+                {
+                    x = t;
+                    y = size - 1 - s;
+                }
+
+                const size_t source = ((size_t)(cell.row * size + y) * cross.width + cell.column * size + x) * channels;
+                const size_t destination = ((size_t)t * size + s) * channels;
+
+                std::memcpy(&faces[face].data[destination], &cross.data[source], channels);
+            }
+        }
+    }
+
+    return faces;
+}
+
+size_t Texture::_totalSourceBytes = 0;
+size_t Texture::_totalGpuBytes = 0;
+
+TextureImportSettings TextureImportSettings::Mipmapped(unsigned maxDimension)
+{
+    TextureImportSettings settings;
+    settings.maxDimension = maxDimension;
+
+    return settings;
+}
+
+TextureImportSettings TextureImportSettings::Sprite(unsigned maxDimension)
+{
+    TextureImportSettings settings;
+    settings.maxDimension = maxDimension;
+    settings.mipmaps = false;
+
+    return settings;
+}
+
+TextureImportSettings TextureImportSettings::Cubemap(unsigned maxDimension)
+{
+    TextureImportSettings settings;
+    settings.maxDimension = maxDimension;
+    settings.cubemap = true;
+
+    return settings;
+}
+
+size_t TextureImage::GetByteSize() const
+{
+    size_t size = 0;
+
+    for (const auto& level : levels)
+    {
+        size += level.data.size();
+    }
+
+    return size;
+}
+
+bool Texture::IsS3tcSupported()
+{
+    static const bool supported = IsExtensionSupported("GL_EXT_texture_compression_s3tc");
+
+    return supported;
+}
+
+bool Texture::Decode(const std::string& fileName, const TextureImportSettings& settings, bool s3tcSupported, TextureImage& image)
+{
+    image.mipmaps = settings.mipmaps;
+
+    auto tooLarge = [&](const TextureLevel& level)
+    {
+        return settings.maxDimension > 0 && std::max(level.width, level.height) > settings.maxDimension && (level.width > 1 || level.height > 1);
+    };
+
+    // cooked by the AssetCooker pre-build step. A cooked cross would be a plain 2D texture, cube maps come from the PNG
+    if (!settings.cubemap && ReadKtx2File(fileName.substr(0, fileName.find_last_of('.')) + ".ktx2", image.format, image.levels) &&
+        (s3tcSupported || (image.format != TextureFormat::BC1 && image.format != TextureFormat::BC3)))
+    {
+        image.channels = 4;
+        image.sourceBytes = (size_t)image.levels[0].width * image.levels[0].height * 4 * 4 / 3;
+
+        // the smaller sizes are already there as mips, start the chain at the first one that fits
+        while (image.levels.size() > 1 && tooLarge(image.levels[0]))
+        {
+            image.levels.erase(image.levels.begin());
+        }
+
+        if (!settings.mipmaps)
+        {
+            image.levels.resize(1);
+        }
+
+        return true;
+    }
+
+    int width;
+    int height;
+    int nrChannels;
+    unsigned char* data = stbi_load(fileName.c_str(), &width, &height, &nrChannels, settings.channels);
+
+    if (!data)
+    {
+        std::cout << "Failed to load texture " << fileName << std::endl;
+        return false;
+    }
+
+    // stb_image reports the channels in the file even when it converted to the requested count
+    if (settings.channels != 0)
+    {
+        nrChannels = settings.channels;
+    }
+
+    image.format = TextureFormat::RGBA8;
+    image.channels = nrChannels;
+
+    // what the loader used to keep - full size with glGenerateMipmap
+    image.sourceBytes = (size_t)width * height * nrChannels * 4 / 3;
+
+    image.levels.resize(1);
+    image.levels[0].width = width;
+    image.levels[0].height = height;
+    image.levels[0].data.assign(data, data + (size_t)width * height * nrChannels);
+
+    stbi_image_free(data);
+
+    if (settings.cubemap)
+    {
+        if (width != height || width % 4 != 0)
+        {
+            std::cout << "ERROR::TEXTURE::CUBEMAP_NOT_A_CROSS " << fileName << std::endl;
+            return false;
+        }
+
+        image.cubemap = true;
+        image.levels = SplitCubemapCross(image.levels[0], nrChannels);
+
+        for (auto& face : image.levels)
+        {
+            while (tooLarge(face))
+            {
+                face = DownsampleTextureLevel(face, nrChannels);
+            }
+        }
+
+        return true;
+    }
+
+    while (tooLarge(image.levels[0]))
+    {
+        image.levels[0] = DownsampleTextureLevel(image.levels[0], nrChannels);
+    }
+
+    return true;
+}
+
+void Texture::Upload(const TextureImage& image, TextureFilter filter, bool fromPixelUnpackBuffer)
 {
-    // generate and bind the textures
-    glGenTextures(1, &_texture);
-    glBindTexture(GL_TEXTURE_2D, _texture);
+    if (image.cubemap)
+    {
+        UploadCubemap(image, filter, fromPixelUnpackBuffer);
+        return;
+    }
+
+    // create and bind the texture. glBindTextureUnit needs a created object, a glGenTextures name is not one until bound
+    glCreateTextures(GL_TEXTURE_2D, 1, &_handle->texture);
+    RenderState::BindTexture(0, _handle->texture);
+
+    // PNGs get their mips generated below, cooked textures bring theirs
+    const bool mipmaps = image.mipmaps && (image.levels.size() > 1 || image.format == TextureFormat::RGBA8);
+
+    GLint minFilter = filter == TextureFilter::Linear ? GL_LINEAR : GL_NEAREST;
+
+    if (mipmaps)
+    {
+        minFilter = filter == TextureFilter::Linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+    }
 
     // set the texture wrapping/filtering options (on the currently bound texture object)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter == TextureFilter::Linear ? GL_LINEAR : GL_NEAREST);
 
-    int nrChannels;
-    unsigned char* data = stbi_load(fileName.c_str(), &_width, &_height, &nrChannels, 0);
+    if (image.levels.empty())
+    {
+        return;
+    }
+
+    _handle->width = image.levels[0].width;
+    _handle->height = image.levels[0].height;
+    _handle->gpuBytes = image.GetByteSize();
+
+    // rows of 1 and 3 channel images are not 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    if (data)
+    size_t offset = 0;
+
+    auto levelSource = [&](const TextureLevel& level)
+    {
+        const void* source = fromPixelUnpackBuffer ? reinterpret_cast<const void*>(offset) : level.data.data();
+        offset += level.data.size();
+
+        return source;
+    };
+
+    // a PNG, one level in whatever channels it had
+    if (image.levels.size() == 1 && image.format == TextureFormat::RGBA8)
     {
         GLenum format = GL_RGB;
 
-        if (nrChannels == 1)
+        if (image.channels == 1)
         {
             format = GL_RED;
         }
-        else if (nrChannels == 3)
+        else if (image.channels == 3)
         {
             format = GL_RGB;
         }
-        else if (nrChannels == 4)
+        else if (image.channels == 4)
         {
             format = GL_RGBA;
         }
 
-        glTexImage2D(GL_TEXTURE_2D, 0, format, _width, _height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, _handle->width, _handle->height, 0, format, GL_UNSIGNED_BYTE, levelSource(image.levels[0]));
+
+        if (mipmaps)
+        {
+            glGenerateMipmap(GL_TEXTURE_2D);
+            _handle->gpuBytes = _handle->gpuBytes * 4 / 3;
+        }
+        else
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        }
     }
     else
     {
-        std::cout << "Failed to load texture" << std::endl;
+        GLenum internalFormat = GL_RGBA8;
+
+        switch (image.format)
+        {
+            case TextureFormat::BC1: internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+            case TextureFormat::BC3: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+            case TextureFormat::BC7: internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+            default: break;
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+        glTexStorage2D(GL_TEXTURE_2D, (GLsizei)image.levels.size(), internalFormat, _handle->width, _handle->height);
+
+        for (size_t i = 0; i < image.levels.size(); i++)
+        {
+            const auto& level = image.levels[i];
+
+            if (image.format == TextureFormat::RGBA8)
+            {
+                glTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, 0, level.width, level.height, GL_RGBA, GL_UNSIGNED_BYTE, levelSource(level));
+            }
+            else
+            {
+                glCompressedTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, 0, level.width, level.height, internalFormat, (GLsizei)level.data.size(), levelSource(level));
+            }
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    _totalSourceBytes += image.sourceBytes;
+    _totalGpuBytes += _handle->gpuBytes;
+}
+
+void Texture::UploadCubemap(const TextureImage& image, TextureFilter filter, bool fromPixelUnpackBuffer)
+{
+    glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &_handle->texture);
+
+    if (image.levels.size() != 6)
+    {
+        return;
     }
 
-    stbi_image_free(data);
+    const GLsizei size = image.levels[0].width;
+    GLsizei mipCount = 1;
+
+    while (image.mipmaps && (size >> mipCount) > 0)
+    {
+        mipCount++;
+    }
+
+    GLint minFilter = filter == TextureFilter::Linear ? GL_LINEAR : GL_NEAREST;
+
+    if (mipCount > 1)
+    {
+        minFilter = filter == TextureFilter::Linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+    }
+
+    // clamped so the edges of a face never blend with its opposite side
+    glTextureParameteri(_handle->texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(_handle->texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(_handle->texture, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(_handle->texture, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTextureParameteri(_handle->texture, GL_TEXTURE_MAG_FILTER, filter == TextureFilter::Linear ? GL_LINEAR : GL_NEAREST);
+
+    GLenum format = GL_RGBA;
+    GLenum internalFormat = GL_RGBA8;
+
+    if (image.channels == 1)
+    {
+        format = GL_RED;
+        internalFormat = GL_R8;
+    }
+    else if (image.channels == 3)
+    {
+        format = GL_RGB;
+        internalFormat = GL_RGB8;
+    }
+
+    _handle->width = size;
+    _handle->height = size;
+    _handle->gpuBytes = mipCount > 1 ? image.GetByteSize() * 4 / 3 : image.GetByteSize();
+
+    glTextureStorage2D(_handle->texture, mipCount, internalFormat, size, size);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    size_t offset = 0;
+
+    // the faces are the layers of the cube map, one after another in the unpack buffer like the levels of a 2D texture
+    for (GLint face = 0; face < 6; face++)
+    {
+        const auto& level = image.levels[face];
+        const void* source = fromPixelUnpackBuffer ? reinterpret_cast<const void*>(offset) : level.data.data();
+        offset += level.data.size();
+
+        glTextureSubImage3D(_handle->texture, 0, 0, 0, face, size, size, 1, format, GL_UNSIGNED_BYTE, source);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (mipCount > 1)
+    {
+        glGenerateTextureMipmap(_handle->texture);
+    }
+
+    _totalSourceBytes += image.sourceBytes;
+    _totalGpuBytes += _handle->gpuBytes;
+}
+
+unsigned int Texture::Load(const std::string& fileName, const TextureImportSettings& settings)
+{
+    TextureImage image;
+    Decode(fileName, settings, IsS3tcSupported(), image);
+    Upload(image, settings.filter);
 
-    return _texture;
+    return _handle->texture;
 }
 
 void Texture::Bind(unsigned textureSlot) const
 {
-    glActiveTexture(GL_TEXTURE0 + textureSlot);
-    glBindTexture(GL_TEXTURE_2D, _texture);
+    RenderState::BindTexture(textureSlot, _handle->texture);
 }
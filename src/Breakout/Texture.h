@@ -1,21 +1,119 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "TextureFile.h"
+
+enum class TextureFilter
+{
+	Nearest,
+	Linear
+};
+
+// How a texture is brought in, chosen per texture by what it is drawn as
+struct TextureImportSettings
+{
+	// largest width or height kept, 0 keeps the source size. Halves the image until it fits
+	unsigned maxDimension = 0;
+
+	// full mip chain sampled with trilinear filtering, off for sprites drawn near their imported size
+	bool mipmaps = true;
+
+	TextureFilter filter = TextureFilter::Linear;
+
+	// channels requested from PNGs, 0 keeps what the file has. Cooked textures keep their own format
+	int channels = 0;
+
+	// the PNG is a horizontal cross on a 4x4 grid and becomes a cube map, maxDimension then limits each face
+	bool cubemap = false;
+
+	// a texture on a 3D model, trilinear filtered and capped at maxDimension
+	static TextureImportSettings Mipmapped(unsigned maxDimension);
+
+	// a screen-space sprite that is never drawn larger than maxDimension pixels
+	static TextureImportSettings Sprite(unsigned maxDimension);
+
+	// a sky cross sampled by view direction, trilinear filtered with faces up to maxDimension
+	static TextureImportSettings Cubemap(unsigned maxDimension);
+};
+
+// Pixels read from disk without touching GL, so it can happen on a loader thread. See Texture::Decode
+struct TextureImage
+{
+	TextureFormat format = TextureFormat::RGBA8;
+
+	// 1 to 4 for images decoded from a PNG, 4 for everything cooked
+	int channels = 4;
+
+	// a PNG has only level 0 and gets its mips generated after the upload
+	std::vector<TextureLevel> levels;
+
+	// levels then holds the six faces, +X -X +Y -Y +Z -Z, each to get its mips generated
+	bool cubemap = false;
+
+	// bytes the full resolution image would take uncompressed with generated mips, for the memory report
+	size_t sourceBytes = 0;
+
+	bool mipmaps = true;
+
+	size_t GetByteSize() const;
+};
+
+// Copies share one GL texture, so a copy taken before an asynchronous upload has finished still sees it
 class Texture
 {
 public:
-	unsigned int Load(const std::string& fileName);
+	Texture() = default;
+
+	// moves copy on purpose - the game hands the same texture to many objects
+	Texture(const Texture&) = default;
+	Texture& operator=(const Texture&) = default;
+
+	// decodes and uploads on the calling thread
+	unsigned int Load(const std::string& fileName, const TextureImportSettings& settings = TextureImportSettings());
 	void Bind(unsigned textureSlot = 0) const;
 
-	int GetWidth() const { return _width; }
-	int GetHeight() const { return _height; }
+	// reads the cooked .ktx2 next to the image if there is one the driver can sample, the image itself otherwise.
+	// Applies the size, mip and channel settings. Does not use GL, s3tcSupported has to be queried up front with IsS3tcSupported
+	static bool Decode(const std::string& fileName, const TextureImportSettings& settings, bool s3tcSupported, TextureImage& image);
+
+	// creates the GL texture from decoded pixels. With fromPixelUnpackBuffer the levels are read from the
+	// bound GL_PIXEL_UNPACK_BUFFER instead, packed one after another from offset 0
+	void Upload(const TextureImage& image, TextureFilter filter, bool fromPixelUnpackBuffer = false);
+
+	// BC1 and BC3 are an extension on paper, BC7 is core since GL 4.2
+	static bool IsS3tcSupported();
 
-	int GetTexture() const { return _texture; }
+	int GetWidth() const { return _handle->width; }
+	int GetHeight() const { return _handle->height; }
+
+	int GetTexture() const { return _handle->texture; }
+
+	// video memory of this texture including mips
+	size_t GetGpuBytes() const { return _handle->gpuBytes; }
+
+	// totals over every upload so far - what the images would have taken at full size uncompressed, and what they take
+	static size_t GetTotalSourceBytes() { return _totalSourceBytes; }
+	static size_t GetTotalGpuBytes() { return _totalGpuBytes; }
 
 private:
-	unsigned int _texture = 0;
+	// six faces in one immutable GL_TEXTURE_CUBE_MAP, mips generated by the driver
+	void UploadCubemap(const TextureImage& image, TextureFilter filter, bool fromPixelUnpackBuffer);
+
+	struct Handle
+	{
+		unsigned int texture = 0;
+
+		int width = 0;
+		int height = 0;
+
+		size_t gpuBytes = 0;
+	};
+
+	static size_t _totalSourceBytes;
+	static size_t _totalGpuBytes;
 
-	int _width = 0;
-	int _height = 0;
+	std::shared_ptr<Handle> _handle = std::make_shared<Handle>();
 };
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// VkFormat values stored in the header - the UNORM variants, the game samples textures as linear colour
+const uint32_t VK_FORMAT_R8G8B8A8_UNORM = 37;
+const uint32_t VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131;
+const uint32_t VK_FORMAT_BC3_UNORM_BLOCK = 137;
+const uint32_t VK_FORMAT_BC7_UNORM_BLOCK = 145;
+
+static uint32_t ToVkFormat(TextureFormat format)
+{
+	switch (format)
+	{
+		case TextureFormat::BC1: return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		case TextureFormat::BC3: return VK_FORMAT_BC3_UNORM_BLOCK;
+		case TextureFormat::BC7: return VK_FORMAT_BC7_UNORM_BLOCK;
+		default: return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+static bool FromVkFormat(uint32_t vkFormat, TextureFormat& format)
+{
+	switch (vkFormat)
+	{
+		case VK_FORMAT_R8G8B8A8_UNORM: format = TextureFormat::RGBA8; return true;
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK: format = TextureFormat::BC1; return true;
+		case VK_FORMAT_BC3_UNORM_BLOCK: format = TextureFormat::BC3; return true;
+		case VK_FORMAT_BC7_UNORM_BLOCK: format = TextureFormat::BC7; return true;
+		default: return false;
+	}
+}
+
+static uint32_t GetBlockBytes(TextureFormat format)
+{
+	switch (format)
+	{
+		case TextureFormat::BC1: return 8;
+		case TextureFormat::BC3: return 16;
+		case TextureFormat::BC7: return 16;
+		default: return 4;
+	}
+}
+
+size_t GetTextureLevelSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+	if (format == TextureFormat::RGBA8)
+	{
+		return (size_t)width * height * 4;
+	}
+
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+}
+
+TextureLevel DownsampleTextureLevel(const TextureLevel& source, int channels)
+{
+	TextureLevel level;
+	level.width = std::max(1u, source.width / 2);
+	level.height = std::max(1u, source.height / 2);
+	level.data.resize((size_t)level.width * level.height * channels);
+
+	for (uint32_t y = 0; y < level.height; y++)
+	{
+		const uint32_t y0 = y * 2;
+		const uint32_t y1 = y == level.height - 1 ? source.height - 1 : y0 + 1;
+
+		for (uint32_t x = 0; x < level.width; x++)
+		{
+			const uint32_t x0 = x * 2;
+			const uint32_t x1 = x == level.width - 1 ? source.width - 1 : x0 + 1;
+
+			for (int c = 0; c < channels; c++)
+			{
+				unsigned sum = 0;
+				unsigned count = 0;
+
+				for (uint32_t sy = y0; sy <= y1; sy++)
+				{
+					for (uint32_t sx = x0; sx <= x1; sx++)
+					{
+						sum += source.data[((size_t)sy * source.width + sx) * channels + c];
+						count++;
+					}
+				}
+
+				level.data[((size_t)y * level.width + x) * channels + c] = (unsigned char)((sum + count / 2) / count);
+			}
+		}
+	}
+
+	return level;
+}
+
+const char* GetTextureFormatName(TextureFormat format)
+{
+	switch (format)
+	{
+		case TextureFormat::BC1: return "BC1";
+		case TextureFormat::BC3: return "BC3";
+		case TextureFormat::BC7: return "BC7";
+		default: return "RGBA8";
+	}
+}
+
+static void WriteU8(std::vector<unsigned char>& out, uint32_t value)
+{
+	out.push_back((unsigned char)value);
+}
+
+static void WriteU16(std::vector<unsigned char>& out, uint32_t value)
+{
+	WriteU8(out, value & 0xFF);
+	WriteU8(out, value >> 8);
+}
+
+static void WriteU32(std::vector<unsigned char>& out, uint32_t value)
+{
+	WriteU16(out, value & 0xFFFF);
+	WriteU16(out, value >> 16);
+}
+
+// Khronos data format descriptor with a single basic block, required by the KTX2 spec
+static std::vector<unsigned char> BuildDataFormatDescriptor(TextureFormat format)
+{
+	struct Sample
+	{
+		uint32_t bitOffset;
+		uint32_t bitLength;
+		uint32_t channel;
+		uint32_t upper;
+	};
+
+	// colour model, channel ids and texel block size as listed in the Khronos data format spec
+	uint32_t colorModel = 1;
+	uint32_t blockSize = 1;
+	std::vector<Sample> samples;
+
+	switch (format)
+	{
+		case TextureFormat::BC1:
+			colorModel = 128;
+			blockSize = 4;
+			samples = { { 0, 64, 0, 0xFFFFFFFF } };
+			break;
+		case TextureFormat::BC3:
+			colorModel = 130;
+			blockSize = 4;
+			samples = { { 0, 64, 15, 0xFFFFFFFF }, { 64, 64, 0, 0xFFFFFFFF } };
+			break;
+		case TextureFormat::BC7:
+			colorModel = 134;
+			blockSize = 4;
+			samples = { { 0, 128, 0, 0xFFFFFFFF } };
+			break;
+		default:
+			samples = { { 0, 8, 0, 255 }, { 8, 8, 1, 255 }, { 16, 8, 2, 255 }, { 24, 8, 15, 255 } };
+			break;
+	}
+
+	const uint32_t blockBytes = 24 + 16 * (uint32_t)samples.size();
+
+	std::vector<unsigned char> dfd;
+	WriteU32(dfd, 4 + blockBytes);
+
+	// vendor and descriptor type (Khronos, basic), version 2
+	WriteU32(dfd, 0);
+	WriteU16(dfd, 2);
+	WriteU16(dfd, blockBytes);
+
+	// colour model, BT.709 primaries, linear transfer, straight alpha
+	WriteU8(dfd, colorModel);
+	WriteU8(dfd, 1);
+	WriteU8(dfd, 1);
+	WriteU8(dfd, 0);
+
+	// texel block dimensions minus one
+	WriteU8(dfd, blockSize - 1);
+	WriteU8(dfd, blockSize - 1);
+	WriteU8(dfd, 0);
+	WriteU8(dfd, 0);
+
+	// bytes per plane
+	WriteU8(dfd, GetBlockBytes(format));
+
+	for (int i = 0; i < 7; i++)
+	{
+		WriteU8(dfd, 0);
+	}
+
+	for (const auto& sample : samples)
+	{
+		WriteU16(dfd, sample.bitOffset);
+		WriteU8(dfd, sample.bitLength - 1);
+		WriteU8(dfd, sample.channel);
+		WriteU32(dfd, 0);
+		WriteU32(dfd, 0);
+		WriteU32(dfd, sample.upper);
+	}
+
+	return dfd;
+}
+
+bool WriteKtx2File(const std::string& path, TextureFormat format, const std::vector<TextureLevel>& levels)
+{
+	if (levels.empty())
+	{
+		return false;
+	}
+
+	std::ofstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	const std::vector<unsigned char> dfd = BuildDataFormatDescriptor(format);
+
+	Ktx2Header header = {};
+	std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(header.identifier));
+	header.vkFormat = ToVkFormat(format);
+	header.typeSize = 1;
+	header.pixelWidth = levels[0].width;
+	header.pixelHeight = levels[0].height;
+	header.faceCount = 1;
+	header.levelCount = (uint32_t)levels.size();
+	header.dfdByteOffset = (uint32_t)(sizeof(Ktx2Header) + levels.size() * sizeof(Ktx2LevelIndex));
+	header.dfdByteLength = (uint32_t)dfd.size();
+
+	// level data is stored smallest mip first, each level aligned to the block size
+	const uint64_t alignment = GetBlockBytes(format);
+
+	std::vector<Ktx2LevelIndex> levelIndex(levels.size());
+	uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+
+	for (size_t i = levels.size(); i-- > 0;)
+	{
+		offset = (offset + alignment - 1) / alignment * alignment;
+
+		levelIndex[i].byteOffset = offset;
+		levelIndex[i].byteLength = levels[i].data.size();
+		levelIndex[i].uncompressedByteLength = levels[i].data.size();
+
+		offset += levels[i].data.size();
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(levelIndex.data()), levelIndex.size() * sizeof(Ktx2LevelIndex));
+	file.write(reinterpret_cast<const char*>(dfd.data()), dfd.size());
+
+	for (size_t i = levels.size(); i-- > 0;)
+	{
+		const std::vector<char> padding((size_t)(levelIndex[i].byteOffset - (uint64_t)file.tellp()), 0);
+		file.write(padding.data(), padding.size());
+		file.write(reinterpret_cast<const char*>(levels[i].data.data()), levels[i].data.size());
+	}
+
+	return file.good();
+}
+
+bool ReadKtx2File(const std::string& path, TextureFormat& format, std::vector<TextureLevel>& levels)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	Ktx2Header header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!file || std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(header.identifier)) != 0 ||
+		!FromVkFormat(header.vkFormat, format) || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 ||
+		header.supercompressionScheme != 0 || header.levelCount == 0)
+	{
+		return false;
+	}
+
+	std::vector<Ktx2LevelIndex> levelIndex(header.levelCount);
+	file.read(reinterpret_cast<char*>(levelIndex.data()), levelIndex.size() * sizeof(Ktx2LevelIndex));
+
+	levels.resize(header.levelCount);
+
+	for (uint32_t i = 0; i < header.levelCount; i++)
+	{
+		levels[i].width = header.pixelWidth >> i > 0 ? header.pixelWidth >> i : 1;
+		levels[i].height = header.pixelHeight >> i > 0 ? header.pixelHeight >> i : 1;
+
+		if (levelIndex[i].byteLength != GetTextureLevelSize(format, levels[i].width, levels[i].height))
+		{
+			return false;
+		}
+
+		levels[i].data.resize((size_t)levelIndex[i].byteLength);
+
+		file.seekg((std::streamoff)levelIndex[i].byteOffset);
+		file.read(reinterpret_cast<char*>(levels[i].data.data()), levels[i].data.size());
+	}
+
+	return file.good();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// KTX2 textures written by the AssetCooker and uploaded by Texture::Load without decoding.
+// Only the subset the cooker writes is supported: one 2D layer, one face, no supercompression
+enum class TextureFormat
+{
+	RGBA8,
+	BC1,
+	BC3,
+	BC7
+};
+
+// one mip level, level 0 is the full resolution image
+struct TextureLevel
+{
+	uint32_t width;
+	uint32_t height;
+	std::vector<unsigned char> data;
+};
+
+const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+struct Ktx2Header
+{
+	unsigned char identifier[12];
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	uint32_t supercompressionScheme;
+
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+
+struct Ktx2LevelIndex
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+
+// bytes of a width x height image, whole 4x4 blocks for the BC formats
+size_t GetTextureLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+// halves an uncompressed image with a box filter, odd rows and columns are folded into the last pixel
+TextureLevel DownsampleTextureLevel(const TextureLevel& source, int channels);
+
+const char* GetTextureFormatName(TextureFormat format);
+
+bool WriteKtx2File(const std::string& path, TextureFormat format, const std::vector<TextureLevel>& levels);
+
+bool ReadKtx2File(const std::string& path, TextureFormat& format, std::vector<TextureLevel>& levels);
@@ -0,0 +1,64 @@
+#include "TiledLighting.h"
+
+#include <glad/glad.h>
+
+TiledLighting::TiledLighting()
+{
+	_lightBuffer = std::make_unique<ShaderStorageBuffer>(nullptr, (int)(MAX_LIGHTS * sizeof(PointLight)), GL_DYNAMIC_STORAGE_BIT);
+
+	_lights.reserve(MAX_LIGHTS);
+}
+
+void TiledLighting::Clear()
+{
+	_lights.clear();
+}
+
+void TiledLighting::Add(const PointLight& light)
+{
+	if (_lights.size() < MAX_LIGHTS)
+	{
+		_lights.push_back(light);
+	}
+}
+
+void TiledLighting::Cull(Shader& cullShader, const glm::mat4& view, const glm::mat4& projection, int width, int height)
+{
+	_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+	// a count per tile, then the light indices of every tile. Only written by the GPU,
+	// so it is made again when a larger viewport needs more tiles
+	const int countBytes = (int)(_tilesX * _tilesY * sizeof(GLuint));
+	const int tileBytes = countBytes + (int)(_tilesX * _tilesY * MAX_LIGHTS_PER_TILE * sizeof(GLuint));
+
+	if (!_tileBuffer || _tileBuffer->GetSize() < tileBytes)
+	{
+		_tileBuffer = std::make_unique<ShaderStorageBuffer>(nullptr, tileBytes);
+	}
+
+	// the lights count themselves into the tiles from zero
+	_tileBuffer->Clear(countBytes);
+
+	if (!_lights.empty())
+	{
+		_lightBuffer->SetData(_lights.data(), (int)(_lights.size() * sizeof(PointLight)));
+	}
+
+	_lightBuffer->BindBase(0);
+	_tileBuffer->BindBase(1);
+
+	cullShader.use();
+	cullShader.setFloatMat4("uView", view);
+	cullShader.setFloatMat4("uProjection", projection);
+	cullShader.setFloat2("uViewportSize", glm::vec2((float)width, (float)height));
+	cullShader.setInt("uTilesX", (int)_tilesX);
+	cullShader.setInt("uTilesY", (int)_tilesY);
+	cullShader.setInt("uLightCount", (int)_lights.size());
+
+	// one invocation per light, 64 to a work group
+	glDispatchCompute(((unsigned)_lights.size() + 63) / 64, 1, 1);
+
+	// the lit pass reads the lists right after
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
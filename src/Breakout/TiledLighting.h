@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "buffers/ShaderStorageBuffer.h"
+
+// one element of the std430 light buffer, see res/lightCulling.comp.glsl
+struct PointLight
+{
+	glm::vec3 position;
+	// the light fades to nothing at this distance
+	float radius;
+	glm::vec3 colour;
+	float intensity;
+};
+
+// Forward+ light culling. The lights of a frame go into a storage buffer, a compute pass
+// (res/lightCulling.comp.glsl) splits the screen into TILE_SIZE pixel tiles and lists the
+// lights touching each one, and projection.frag.glsl shades with only its tile's list -
+// so the cost per pixel follows the lights nearby, not the lights in the scene
+class TiledLighting
+{
+public:
+	// tile width and height in pixels, the local size of the compute shader
+	static const unsigned TILE_SIZE = 16;
+
+	// lights added past this are ignored
+	static const unsigned MAX_LIGHTS = 1024;
+
+	// lights past this in one tile are dropped
+	static const unsigned MAX_LIGHTS_PER_TILE = 256;
+
+	TiledLighting();
+
+	void Clear();
+
+	void Add(const PointLight& light);
+
+	unsigned GetCount() const { return (unsigned)_lights.size(); }
+
+	// uploads the lights added since Clear and lists them per tile of a width x height viewport.
+	// Leaves the light buffer on binding 0 and the tile lists on binding 1 for the lit pass
+	void Cull(Shader& cullShader, const glm::mat4& view, const glm::mat4& projection, int width, int height);
+
+	unsigned GetTilesX() const { return _tilesX; }
+	unsigned GetTilesY() const { return _tilesY; }
+
+private:
+	std::vector<PointLight> _lights;
+
+	std::unique_ptr<ShaderStorageBuffer> _lightBuffer;
+	std::unique_ptr<ShaderStorageBuffer> _tileBuffer;
+
+	unsigned _tilesX = 0;
+	unsigned _tilesY = 0;
+};
@@ -0,0 +1,129 @@
+#include "TransformBatch.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define TRANSFORM_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	void ComposeTransform(float positionX, float positionY, float positionZ, float rotation, float scaleX, float scaleY, float scaleZ, ModelInstance& instance)
+	{
+		const float s = std::sin(rotation);
+		const float c = std::cos(rotation);
+
+		// the rotation about y spreads the x and z scales over the x and z rows
+		instance.rows[0] = glm::vec4(c * scaleX, 0.0f, s * scaleZ, positionX);
+		instance.rows[1] = glm::vec4(0.0f, scaleY, 0.0f, positionY);
+		instance.rows[2] = glm::vec4(-s * scaleX, 0.0f, c * scaleZ, positionZ);
+
+		// rotation * cofactor(scale), the inverse transpose up to a positive factor the fragment shader normalizes away.
+		// It needs no division, so a brick that shrank to nothing doesn't produce infinities
+		const float sign = scaleX * scaleY * scaleZ < 0.0f ? -1.0f : 1.0f;
+		const float cofactorX = sign * scaleY * scaleZ;
+		const float cofactorY = sign * scaleX * scaleZ;
+		const float cofactorZ = sign * scaleX * scaleY;
+
+		instance.normalRows[0] = glm::vec4(c * cofactorX, 0.0f, s * cofactorZ, 0.0f);
+		instance.normalRows[1] = glm::vec4(0.0f, cofactorY, 0.0f, 0.0f);
+		instance.normalRows[2] = glm::vec4(-s * cofactorX, 0.0f, c * cofactorZ, 0.0f);
+	}
+
+#ifdef TRANSFORM_SSE
+	// sine and cosine of four angles. The angle is reduced to [-pi/4, pi/4] around the nearest multiple
+	// of pi/2 and both polynomials are evaluated there (Cephes sinf/cosf), the quadrant picks and signs them
+	void SinCos(__m128 x, __m128& sine, __m128& cosine)
+	{
+		const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772f)));
+		const __m128 q = _mm_cvtepi32_ps(quadrant);
+
+		// pi/2 in three parts, so the reduction stays exact for large angles
+		x = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+		x = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+		x = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(7.549789948768648e-8f)));
+
+		const __m128 x2 = _mm_mul_ps(x, x);
+
+		__m128 sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), x2), _mm_set1_ps(8.3321608736e-3f));
+		sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, x2), _mm_set1_ps(-1.6666654611e-1f));
+		sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, x2), x), x);
+
+		__m128 cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), x2), _mm_set1_ps(-1.388731625493765e-3f));
+		cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, x2), _mm_set1_ps(4.166664568298827e-2f));
+		cosPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cosPoly, x2), x2), _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, _mm_set1_ps(0.5f))));
+
+		// odd quadrants swap sine and cosine
+		const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+
+		sine = _mm_or_ps(_mm_and_ps(swap, cosPoly), _mm_andnot_ps(swap, sinPoly));
+		cosine = _mm_or_ps(_mm_and_ps(swap, sinPoly), _mm_andnot_ps(swap, cosPoly));
+
+		// the sine is negative in quadrants 2 and 3, the cosine in 1 and 2
+		const __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+		const __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+		sine = _mm_xor_ps(sine, sineSign);
+		cosine = _mm_xor_ps(cosine, cosineSign);
+	}
+#endif
+}
+
+void ComposeTransforms(const float* positionX, const float* positionY, const float* positionZ, const float* rotation,
+	const float* scaleX, const float* scaleY, const float* scaleZ, unsigned count, ModelInstance* instances)
+{
+	unsigned i = 0;
+
+#ifdef TRANSFORM_SSE
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 s, c;
+		SinCos(_mm_loadu_ps(rotation + i), s, c);
+
+		const __m128 sx = _mm_loadu_ps(scaleX + i);
+		const __m128 sy = _mm_loadu_ps(scaleY + i);
+		const __m128 sz = _mm_loadu_ps(scaleZ + i);
+		const __m128 zero = _mm_setzero_ps();
+
+		// cofactors of the scale, negated when the scale mirrors - the sign of the determinant is the xor of the three signs
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 sign = _mm_and_ps(_mm_xor_ps(_mm_xor_ps(sx, sy), sz), signMask);
+		const __m128 cx = _mm_xor_ps(_mm_mul_ps(sy, sz), sign);
+		const __m128 cy = _mm_xor_ps(_mm_mul_ps(sx, sz), sign);
+		const __m128 cz = _mm_xor_ps(_mm_mul_ps(sx, sy), sign);
+
+		// one register per matrix element, then transposed to one register per row of each object
+		__m128 row0[4] = { _mm_mul_ps(c, sx), zero, _mm_mul_ps(s, sz), _mm_loadu_ps(positionX + i) };
+		__m128 row1[4] = { zero, sy, zero, _mm_loadu_ps(positionY + i) };
+		__m128 row2[4] = { _mm_sub_ps(zero, _mm_mul_ps(s, sx)), zero, _mm_mul_ps(c, sz), _mm_loadu_ps(positionZ + i) };
+
+		__m128 normalRow0[4] = { _mm_mul_ps(c, cx), zero, _mm_mul_ps(s, cz), zero };
+		__m128 normalRow1[4] = { zero, cy, zero, zero };
+		__m128 normalRow2[4] = { _mm_sub_ps(zero, _mm_mul_ps(s, cx)), zero, _mm_mul_ps(c, cz), zero };
+
+		_MM_TRANSPOSE4_PS(row0[0], row0[1], row0[2], row0[3]);
+		_MM_TRANSPOSE4_PS(row1[0], row1[1], row1[2], row1[3]);
+		_MM_TRANSPOSE4_PS(row2[0], row2[1], row2[2], row2[3]);
+		_MM_TRANSPOSE4_PS(normalRow0[0], normalRow0[1], normalRow0[2], normalRow0[3]);
+		_MM_TRANSPOSE4_PS(normalRow1[0], normalRow1[1], normalRow1[2], normalRow1[3]);
+		_MM_TRANSPOSE4_PS(normalRow2[0], normalRow2[1], normalRow2[2], normalRow2[3]);
+
+		for (unsigned j = 0; j < 4; j++)
+		{
+			_mm_storeu_ps(&instances[i + j].rows[0].x, row0[j]);
+			_mm_storeu_ps(&instances[i + j].rows[1].x, row1[j]);
+			_mm_storeu_ps(&instances[i + j].rows[2].x, row2[j]);
+			_mm_storeu_ps(&instances[i + j].normalRows[0].x, normalRow0[j]);
+			_mm_storeu_ps(&instances[i + j].normalRows[1].x, normalRow1[j]);
+			_mm_storeu_ps(&instances[i + j].normalRows[2].x, normalRow2[j]);
+		}
+	}
+#endif
+
+	// remaining objects
+	for (; i < count; i++)
+	{
+		ComposeTransform(positionX[i], positionY[i], positionZ[i], rotation[i], scaleX[i], scaleY[i], scaleZ[i], instances[i]);
+	}
+}
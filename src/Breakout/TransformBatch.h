@@ -0,0 +1,9 @@
+#pragma once
+
+#include "models/Model.h"
+
+// Builds the model matrix translate(position) * rotateY(rotation) * scale(scale) of count objects,
+// given as one array per component, straight into the rows of their instances. Four objects are
+// composed at a time with SSE, including the sine and cosine. The normal matrix goes next to it, colours are left as they are
+void ComposeTransforms(const float* positionX, const float* positionY, const float* positionZ, const float* rotation,
+	const float* scaleX, const float* scaleY, const float* scaleZ, unsigned count, ModelInstance* instances);
@@ -0,0 +1,51 @@
+#include "Vertex.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+PackedVertex PackVertex(const Vertex& vertex)
+{
+	PackedVertex packed;
+	packed.Position = vertex.Position;
+
+	packed.TexCoords[0] = glm::packHalf1x16(vertex.TexCoords.x);
+	packed.TexCoords[1] = glm::packHalf1x16(vertex.TexCoords.y);
+
+	// project the normal onto the octahedron |x| + |y| + |z| = 1 and fold the lower half over the upper one.
+	// Degenerate faces can leave a zero (or NaN) normal, which would pack as NaN - those point along +z
+	const float sum = glm::abs(vertex.Normal.x) + glm::abs(vertex.Normal.y) + glm::abs(vertex.Normal.z);
+	glm::vec3 normal = sum > 0.0f ? vertex.Normal / sum : glm::vec3(0.0f, 0.0f, 1.0f);
+	glm::vec2 encoded = glm::vec2(normal.x, normal.y);
+
+	if (normal.z < 0.0f)
+	{
+		encoded.x = (1.0f - glm::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f);
+		encoded.y = (1.0f - glm::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	packed.Normal[0] = (int16_t)glm::packSnorm1x16(encoded.x);
+	packed.Normal[1] = (int16_t)glm::packSnorm1x16(encoded.y);
+
+	return packed;
+}
+
+Vertex UnpackVertex(const PackedVertex& packed)
+{
+	Vertex vertex = {};
+	vertex.Position = packed.Position;
+
+	vertex.TexCoords.x = glm::unpackHalf1x16(packed.TexCoords[0]);
+	vertex.TexCoords.y = glm::unpackHalf1x16(packed.TexCoords[1]);
+
+	// same decode as projection.vert.glsl
+	const glm::vec2 encoded(glm::unpackSnorm1x16((uint16_t)packed.Normal[0]), glm::unpackSnorm1x16((uint16_t)packed.Normal[1]));
+	glm::vec3 normal(encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y));
+
+	const float fold = glm::max(-normal.z, 0.0f);
+	normal.x += normal.x >= 0.0f ? -fold : fold;
+	normal.y += normal.y >= 0.0f ? -fold : fold;
+
+	vertex.Normal = glm::normalize(normal);
+
+	return vertex;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
@@ -17,3 +19,16 @@ struct Vertex
 	glm::vec3 Bitangent;
 };
 
+// 20 byte vertex uploaded to the GPU, holding only what the shaders read
+struct PackedVertex
+{
+	// position - Float3
+	glm::vec3 Position;
+	// texCoords - Half2
+	uint16_t TexCoords[2];
+	// octahedral encoded unit normal - Short2Norm
+	int16_t Normal[2];
+};
+
+PackedVertex PackVertex(const Vertex& vertex);
+Vertex UnpackVertex(const PackedVertex& packed);
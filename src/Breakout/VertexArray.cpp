@@ -2,47 +2,72 @@
 
 #include <glad/glad.h>
 
+#include "RenderState.h"
+
 VertexArray::VertexArray()
 {
-	glGenVertexArrays(1, &id);
+	glCreateVertexArrays(1, &id);
+}
+
+VertexArray::~VertexArray()
+{
+	RenderState::OnVertexArrayDeleted(id);
+	glDeleteVertexArrays(1, &id);
 }
 
-void VertexArray::Bind()
+void VertexArray::Bind() const
 {
-	glBindVertexArray(id);
+	RenderState::BindVertexArray(id);
 }
 
-void VertexArray::Unbind()
+void VertexArray::Unbind() const
 {
-	glBindVertexArray(0);
+	RenderState::BindVertexArray(0);
 }
 
-void VertexArray::SetVertexBuffer(std::unique_ptr<VertexBuffer> vb)
+void VertexArray::SetVertexBuffer(std::unique_ptr<VertexBuffer> vb, unsigned divisor)
 {
-	Bind();
-	vb->Bind();
+	ShareVertexBuffer(*vb, divisor);
 
-	const auto& layout = vb->GetLayout();
+	vbos.push_back(std::move(vb));
+}
+
+void VertexArray::ShareVertexBuffer(const VertexBuffer& vb, unsigned divisor)
+{
+	const auto binding = bindingCount++;
+	const auto& layout = vb.GetLayout();
 
-	auto i = 0;
+	glVertexArrayVertexBuffer(id, binding, vb.GetID(), 0, layout.GetStride());
+	glVertexArrayBindingDivisor(id, binding, divisor);
 
 	for (const auto& element : layout)
 	{
-		glVertexAttribPointer(i, GetComponentCount(element.type), GetGLType(element.type),
-			GL_FALSE, layout.GetStride(), (void*)element.offset);
+		const auto i = attributeCount++;
 
-		glEnableVertexAttribArray(i);
+		glEnableVertexArrayAttrib(id, i);
 
-		++i;
-	}
+		if (IsInteger(element.type))
+		{
+			glVertexArrayAttribIFormat(id, i, GetComponentCount(element.type), GetGLType(element.type), element.offset);
+		}
+		else
+		{
+			glVertexArrayAttribFormat(id, i, GetComponentCount(element.type), GetGLType(element.type),
+				element.normalized ? GL_TRUE : GL_FALSE, element.offset);
+		}
 
-	vbo = std::move(vb);
+		glVertexArrayAttribBinding(id, i, binding);
+	}
 }
 
 void VertexArray::SetIndexBuffer(std::unique_ptr<IndexBuffer> ib)
 {
-	Bind();
-	ib->Bind();
+	ShareIndexBuffer(*ib);
 
 	ibo = std::move(ib);
-}
\ No newline at end of file
+}
+
+void VertexArray::ShareIndexBuffer(const IndexBuffer& ib)
+{
+	glVertexArrayElementBuffer(id, ib.GetID());
+}
@@ -1,26 +1,42 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "buffers/IndexBuffer.h"
 #include "buffers/VertexBuffer.h"
 
+// Vertex array set up through direct state access - attribute formats and buffer bindings are
+// recorded without binding anything, so the only bind left is the one before drawing
 class VertexArray
 {
 public:
 	VertexArray();
+	~VertexArray();
 
-	void Bind();
-	void Unbind();
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
 
-	void SetVertexBuffer(std::unique_ptr<VertexBuffer> vb);
+	void Bind() const;
+	void Unbind() const;
+
+	// each vertex buffer gets its own binding point, its attributes continue the locations of the previous one.
+	// A divisor of 1 advances the buffer once per instance instead of once per vertex
+	void SetVertexBuffer(std::unique_ptr<VertexBuffer> vb, unsigned divisor = 0);
 	void SetIndexBuffer(std::unique_ptr<IndexBuffer> ib);
 
+	// the same, reading buffers owned by another vertex array. They must outlive this one
+	void ShareVertexBuffer(const VertexBuffer& vb, unsigned divisor = 0);
+	void ShareIndexBuffer(const IndexBuffer& ib);
+
 	IndexBuffer* GetIBO() { return ibo.get(); }
+	const IndexBuffer* GetIBO() const { return ibo.get(); }
 
 private:
 	unsigned id;
+	unsigned attributeCount = 0;
+	unsigned bindingCount = 0;
 
-	std::unique_ptr<VertexBuffer> vbo;
+	std::vector<std::unique_ptr<VertexBuffer>> vbos;
 	std::unique_ptr<IndexBuffer> ibo;
 };
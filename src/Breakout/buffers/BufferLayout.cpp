@@ -1,9 +1,11 @@
 #include "BufferLayout.h"
 
+#include <cstdint>
+
 #include <glad/glad.h>
 
 BufferElement::BufferElement(std::string name, ShaderDataType type)
-	: name(name), type(type), size(SizeOfType(type))
+	: name(name), type(type), size(SizeOfType(type)), offset(0), normalized(IsNormalized(type))
 {
 
 }
@@ -35,11 +37,40 @@ unsigned SizeOfType(ShaderDataType type)
 	case Float3:
 		return 3 * sizeof(float);
 
+	case Float4:
+		return 4 * sizeof(float);
+
 	case Mat3:
 		return 3 * 3 * sizeof(float);
 
 	case Mat4:
 		return 4 * 4 * sizeof(float);
+
+	case Half2:
+		return 2 * sizeof(uint16_t);
+
+	case Half4:
+		return 4 * sizeof(uint16_t);
+
+	case Byte4Norm:
+	case UByte4Norm:
+	case UByte4:
+		return 4 * sizeof(uint8_t);
+
+	case Short2Norm:
+		return 2 * sizeof(int16_t);
+
+	case Short4Norm:
+		return 4 * sizeof(int16_t);
+
+	case Int2101010Norm:
+		return sizeof(uint32_t);
+
+	case Int:
+		return sizeof(int32_t);
+
+	case UInt:
+		return sizeof(uint32_t);
 	}
 
 	return 0;
@@ -50,14 +81,27 @@ unsigned GetComponentCount(ShaderDataType type)
 	switch (type)
 	{
 	case Float:
+	case Int:
+	case UInt:
 		return 1;
 
 	case Float2:
+	case Half2:
+	case Short2Norm:
 		return 2;
 
 	case Float3:
 		return 3;
 
+	case Float4:
+	case Half4:
+	case Byte4Norm:
+	case UByte4Norm:
+	case Short4Norm:
+	case Int2101010Norm:
+	case UByte4:
+		return 4;
+
 	case Mat3:
 		return 3 * 3;
 
@@ -75,10 +119,65 @@ unsigned GetGLType(ShaderDataType type)
 	case Float:
 	case Float2:
 	case Float3:
+	case Float4:
 	case Mat3:
 	case Mat4:
 		return GL_FLOAT;
+
+	case Half2:
+	case Half4:
+		return GL_HALF_FLOAT;
+
+	case Byte4Norm:
+		return GL_BYTE;
+
+	case UByte4Norm:
+	case UByte4:
+		return GL_UNSIGNED_BYTE;
+
+	case Short2Norm:
+	case Short4Norm:
+		return GL_SHORT;
+
+	case Int2101010Norm:
+		return GL_INT_2_10_10_10_REV;
+
+	case Int:
+		return GL_INT;
+
+	case UInt:
+		return GL_UNSIGNED_INT;
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
+
+bool IsNormalized(ShaderDataType type)
+{
+	switch (type)
+	{
+	case Byte4Norm:
+	case UByte4Norm:
+	case Short2Norm:
+	case Short4Norm:
+	case Int2101010Norm:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool IsInteger(ShaderDataType type)
+{
+	switch (type)
+	{
+	case Int:
+	case UInt:
+	case UByte4:
+		return true;
+
+	default:
+		return false;
+	}
+}
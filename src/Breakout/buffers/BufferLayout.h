@@ -8,8 +8,23 @@ enum ShaderDataType
 	Float,
 	Float2,
 	Float3,
+	Float4,
 	Mat3,
-	Mat4
+	Mat4,
+
+	// compact attribute formats, read by the shader as floats
+	Half2,
+	Half4,
+	Byte4Norm,
+	UByte4Norm,
+	Short2Norm,
+	Short4Norm,
+	Int2101010Norm,
+
+	// integer attributes, read by the shader as int/uint
+	Int,
+	UInt,
+	UByte4
 };
 
 struct BufferElement
@@ -18,6 +33,7 @@ struct BufferElement
 	ShaderDataType type;
 	unsigned size;
 	unsigned offset;
+	bool normalized;
 
 	BufferElement(std::string name, ShaderDataType type);
 };
@@ -48,4 +64,10 @@ private:
 
 unsigned SizeOfType(ShaderDataType type);
 unsigned GetComponentCount(ShaderDataType type);
-unsigned GetGLType(ShaderDataType type);
\ No newline at end of file
+unsigned GetGLType(ShaderDataType type);
+
+// fixed point types mapped to [0, 1] or [-1, 1]
+bool IsNormalized(ShaderDataType type);
+
+// types that have to go through glVertexArrayAttribIFormat
+bool IsInteger(ShaderDataType type);
@@ -2,20 +2,21 @@
 
 #include <glad/glad.h>
 
-IndexBuffer::IndexBuffer(unsigned* data, int count)
-    : _count(count)
+IndexBuffer::IndexBuffer(const unsigned* data, int count)
+    : _count(count), _type(GL_UNSIGNED_INT)
 {
-    glGenBuffers(1, &id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned), data, GL_STATIC_DRAW);
+    glCreateBuffers(1, &id);
+    glNamedBufferStorage(id, count * sizeof(unsigned), data, 0);
 }
 
-void IndexBuffer::Bind()
+IndexBuffer::IndexBuffer(const unsigned short* data, int count)
+    : _count(count), _type(GL_UNSIGNED_SHORT)
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+    glCreateBuffers(1, &id);
+    glNamedBufferStorage(id, count * sizeof(unsigned short), data, 0);
 }
 
-void IndexBuffer::Unbind()
+IndexBuffer::~IndexBuffer()
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDeleteBuffers(1, &id);
 }
@@ -1,15 +1,24 @@
 #pragma once
 
+// Immutable GPU buffer holding 16 or 32-bit indices, created with direct state access
 class IndexBuffer
 {
 public:
-	IndexBuffer(unsigned* data, int size);
+	IndexBuffer(const unsigned* data, int size);
+	IndexBuffer(const unsigned short* data, int size);
+	~IndexBuffer();
 
-	void Bind();
-	void Unbind();
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+
+	unsigned GetID() const { return id; }
 	int GetCount() const { return _count; }
 
+	// GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
+	unsigned GetType() const { return _type; }
+
 private:
 	unsigned int id;
 	int _count;
-};
\ No newline at end of file
+	unsigned _type;
+};
@@ -0,0 +1,30 @@
+#include "ShaderStorageBuffer.h"
+
+#include <glad/glad.h>
+
+ShaderStorageBuffer::ShaderStorageBuffer(const void* data, int size, unsigned flags)
+    : size(size)
+{
+    glCreateBuffers(1, &id);
+    glNamedBufferStorage(id, size, data, flags);
+}
+
+void ShaderStorageBuffer::SetData(const void* data, int size, int offset)
+{
+    glNamedBufferSubData(id, offset, size, data);
+}
+
+void ShaderStorageBuffer::Clear(int size, int offset)
+{
+    glClearNamedBufferSubData(id, GL_R32UI, offset, size, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
+
+void ShaderStorageBuffer::BindBase(unsigned index) const
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, id);
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+    glDeleteBuffers(1, &id);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// Immutable GPU buffer read and written by shaders through a std430 block, created with direct state access
+class ShaderStorageBuffer
+{
+public:
+	// flags are glNamedBufferStorage flags - GL_DYNAMIC_STORAGE_BIT for buffers refilled with SetData
+	ShaderStorageBuffer(const void* data, int size, unsigned flags = 0);
+	~ShaderStorageBuffer();
+
+	ShaderStorageBuffer(const ShaderStorageBuffer&) = delete;
+	ShaderStorageBuffer& operator=(const ShaderStorageBuffer&) = delete;
+
+	unsigned GetID() const { return id; }
+	int GetSize() const { return size; }
+
+	void SetData(const void* data, int size, int offset = 0);
+
+	// zeroes size bytes from offset on the GPU, size and offset are multiples of 4
+	void Clear(int size, int offset = 0);
+
+	// attaches the buffer to the layout(binding = index) block of every program
+	void BindBase(unsigned index) const;
+
+private:
+	unsigned int id;
+	int size;
+};
@@ -2,19 +2,18 @@
 
 #include <glad/glad.h>
 
-VertexBuffer::VertexBuffer(void* data, int size)
+VertexBuffer::VertexBuffer(const void* data, int size, unsigned flags)
 {
-    glGenBuffers(1, &id);
-    glBindBuffer(GL_ARRAY_BUFFER, id);
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    glCreateBuffers(1, &id);
+    glNamedBufferStorage(id, size, data, flags);
 }
 
-void VertexBuffer::Bind()
+void VertexBuffer::SetData(const void* data, int size, int offset)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, id);
+    glNamedBufferSubData(id, offset, size, data);
 }
 
-void VertexBuffer::Unbind()
+VertexBuffer::~VertexBuffer()
 {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDeleteBuffers(1, &id);
 }
@@ -2,20 +2,27 @@
 
 #include "BufferLayout.h"
 
+// Immutable GPU buffer holding vertex attributes, created with direct state access
 class VertexBuffer
 {
 public:
-	VertexBuffer(void* data, int size);
+	// flags are glNamedBufferStorage flags - GL_DYNAMIC_STORAGE_BIT for buffers refilled with SetData
+	VertexBuffer(const void* data, int size, unsigned flags = 0);
+	~VertexBuffer();
 
-	void Bind();
-	void Unbind();
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+
+	unsigned GetID() const { return id; }
+
+	void SetData(const void* data, int size, int offset = 0);
 
 	void SetLayout(const BufferLayout& layout)
 	{
 		this->layout = layout;
 	}
 
-	const BufferLayout& GetLayout()
+	const BufferLayout& GetLayout() const
 	{
 		return layout;
 	}
@@ -24,4 +31,4 @@ private:
 	unsigned int id;
 
 	BufferLayout layout;
-};
\ No newline at end of file
+};
@@ -0,0 +1,62 @@
+#include "BallImpostors.h"
+
+#include <glad/glad.h>
+
+BallImpostors::BallImpostors(unsigned maxBalls)
+	: _maxBalls(maxBalls)
+{
+	const GLfloat corners[8] =
+	{
+		-1.0f, -1.0f,
+		 1.0f, -1.0f,
+		 1.0f,  1.0f,
+		-1.0f,  1.0f
+	};
+
+	const GLuint indices[6] =
+	{
+		0, 1, 2,
+		2, 3, 0
+	};
+
+	_vao = std::make_unique<VertexArray>();
+
+	auto quad = std::make_unique<VertexBuffer>(corners, (int)sizeof(corners));
+	quad->SetLayout({ {"inCorner", Float2} });
+
+	auto instances = std::make_unique<VertexBuffer>(nullptr, (int)(maxBalls * sizeof(glm::vec4)), GL_DYNAMIC_STORAGE_BIT);
+	instances->SetLayout({ {"inSphere", Float4} });
+	_instanceBuffer = instances.get();
+
+	_vao->SetVertexBuffer(std::move(quad));
+	_vao->SetVertexBuffer(std::move(instances), 1);
+	_vao->SetIndexBuffer(std::make_unique<IndexBuffer>(indices, 6));
+
+	_instances.reserve(maxBalls);
+}
+
+void BallImpostors::Clear()
+{
+	_instances.clear();
+}
+
+void BallImpostors::Add(glm::vec3 center, float radius)
+{
+	if (_instances.size() < _maxBalls)
+	{
+		_instances.push_back(glm::vec4(center, radius));
+	}
+}
+
+void BallImpostors::Render()
+{
+	if (_instances.empty())
+	{
+		return;
+	}
+
+	_instanceBuffer->SetData(_instances.data(), (int)(_instances.size() * sizeof(glm::vec4)));
+
+	_vao->Bind();
+	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, (GLsizei)_instances.size());
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "../VertexArray.h"
+
+// Draws balls as camera facing quads that ray-trace a sphere in the fragment shader
+// (res/ballImpostor.*.glsl). Every ball is one instance of the same quad, so a thousand
+// balls cost one draw call and four vertices each
+class BallImpostors
+{
+public:
+	explicit BallImpostors(unsigned maxBalls);
+
+	void Clear();
+
+	// balls past maxBalls are ignored
+	void Add(glm::vec3 center, float radius);
+
+	// uploads the balls added since Clear and draws them with one instanced call
+	void Render();
+
+	unsigned GetCount() const { return (unsigned)_instances.size(); }
+
+private:
+	unsigned _maxBalls;
+
+	// xyz center, w radius
+	std::vector<glm::vec4> _instances;
+
+	std::unique_ptr<VertexArray> _vao;
+	VertexBuffer* _instanceBuffer;
+};
@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "../RenderState.h"
 #include "../Shader.h"
 
 #include <string>
@@ -44,8 +45,6 @@ public:
 
 		for (unsigned int i = 0; i < _textures.size(); i++)
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
-
 			// retrieve texture number (the N in diffuse_textureN)
 			std::string number;
 			std::string name = _textures[i].type;
@@ -70,17 +69,13 @@ public:
 			// now set the sampler to the correct texture unit
 			shader.setInt(name + number, i);
 
-			// and finally bind the texture
-			glBindTexture(GL_TEXTURE_2D, _textures[i].id);
+			// and finally bind the texture, without switching the active unit
+			RenderState::BindTexture(i, _textures[i].id);
 		}
 
 		// draw mesh
 		_vao->Bind();
-		glDrawElements(GL_TRIANGLES, _vao->GetIBO()->GetCount(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
-
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		glDrawElements(GL_TRIANGLES, _vao->GetIBO()->GetCount(), _vao->GetIBO()->GetType(), 0);
 	}
 
 private:
@@ -90,10 +85,8 @@ private:
 	void setupMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
 	{
 		_vao = std::make_unique<VertexArray>();
-		_vao->Bind();
 
-		auto vbo = std::make_unique<VertexBuffer>(&vertices[0], vertices.size() * sizeof(Vertex));
-		vbo->Bind();
+		auto vbo = std::make_unique<VertexBuffer>(&vertices[0], (int)(vertices.size() * sizeof(Vertex)));
 
 		vbo->SetLayout(
 			{
@@ -105,8 +98,7 @@ private:
 			}
 		);
 
-		auto ibo = std::make_unique<IndexBuffer>(&indices[0], indices.size());
-		ibo->Bind();
+		auto ibo = std::make_unique<IndexBuffer>(&indices[0], (int)indices.size());
 
 		_vao->SetVertexBuffer(std::move(vbo));
 		_vao->SetIndexBuffer(std::move(ibo));
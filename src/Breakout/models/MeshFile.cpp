@@ -0,0 +1,75 @@
+#include "MeshFile.h"
+
+#include <cstring>
+#include <fstream>
+
+bool WriteMeshFile(const std::string& path, const std::vector<PackedVertex>& vertices, const std::vector<unsigned>& indices)
+{
+	std::ofstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	MeshFileHeader header;
+	std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+	header.version = MESH_FILE_VERSION;
+	header.vertexCount = (uint32_t)vertices.size();
+	header.vertexStride = sizeof(PackedVertex);
+	header.indexCount = (uint32_t)indices.size();
+	header.indexSize = vertices.size() <= 0xFFFF ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(PackedVertex));
+
+	if (header.indexSize == sizeof(uint16_t))
+	{
+		std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+		file.write(reinterpret_cast<const char*>(shortIndices.data()), shortIndices.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		file.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint32_t));
+	}
+
+	return file.good();
+}
+
+bool ReadMeshFile(const std::string& path, std::vector<PackedVertex>& vertices, std::vector<uint16_t>& shortIndices, std::vector<unsigned>& indices)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	MeshFileHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!file || std::memcmp(header.magic, MESH_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != MESH_FILE_VERSION || header.vertexStride != sizeof(PackedVertex))
+	{
+		return false;
+	}
+
+	vertices.resize(header.vertexCount);
+	file.read(reinterpret_cast<char*>(vertices.data()), header.vertexCount * sizeof(PackedVertex));
+
+	shortIndices.clear();
+	indices.clear();
+
+	if (header.indexSize == sizeof(uint16_t))
+	{
+		shortIndices.resize(header.indexCount);
+		file.read(reinterpret_cast<char*>(shortIndices.data()), shortIndices.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		indices.resize(header.indexCount);
+		file.read(reinterpret_cast<char*>(indices.data()), indices.size() * sizeof(uint32_t));
+	}
+
+	return file.good();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../Vertex.h"
+
+// Binary mesh written by the AssetCooker and read back by Model::loadBinary.
+// Layout: MeshFileHeader | vertexCount * PackedVertex | indexCount * indexSize bytes
+const char MESH_FILE_MAGIC[4] = { 'B', 'K', 'M', 'S' };
+const uint32_t MESH_FILE_VERSION = 2;
+
+struct MeshFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t indexCount;
+	// 2 when every index fits in 16 bits, 4 otherwise
+	uint32_t indexSize;
+};
+
+bool WriteMeshFile(const std::string& path, const std::vector<PackedVertex>& vertices, const std::vector<unsigned>& indices);
+
+// reads the vertex block straight into vertices and the index block into shortIndices or indices, whichever
+// width it is stored with. The other one is left empty
+bool ReadMeshFile(const std::string& path, std::vector<PackedVertex>& vertices, std::vector<uint16_t>& shortIndices, std::vector<unsigned>& indices);
@@ -0,0 +1,479 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+namespace
+{
+	// the attributes the renderer actually feeds to the shaders
+	struct VertexKey
+	{
+		float data[8];
+
+		explicit VertexKey(const Vertex& vertex)
+		{
+			data[0] = vertex.Position.x;
+			data[1] = vertex.Position.y;
+			data[2] = vertex.Position.z;
+			data[3] = vertex.Normal.x;
+			data[4] = vertex.Normal.y;
+			data[5] = vertex.Normal.z;
+			data[6] = vertex.TexCoords.x;
+			data[7] = vertex.TexCoords.y;
+		}
+
+		bool operator==(const VertexKey& other) const
+		{
+			return std::memcmp(data, other.data, sizeof(data)) == 0;
+		}
+	};
+
+	struct VertexKeyHash
+	{
+		size_t operator()(const VertexKey& key) const
+		{
+			// FNV-1a over the raw bytes
+			size_t hash = 2166136261u;
+			const auto bytes = reinterpret_cast<const unsigned char*>(key.data);
+
+			for (size_t i = 0; i < sizeof(key.data); i++)
+			{
+				hash = (hash ^ bytes[i]) * 16777619u;
+			}
+
+			return hash;
+		}
+	};
+
+	// vertex cache optimization tuning values from Tom Forsyth's paper
+	const int CACHE_SIZE = 32;
+	const float CACHE_DECAY_POWER = 1.5f;
+	const float LAST_TRIANGLE_SCORE = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+
+	float VertexScore(int cachePosition, unsigned activeTriangles)
+	{
+		// no triangles left to draw with this vertex
+		if (activeTriangles == 0)
+		{
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				// used by the last triangle - fixed score so it is not favoured too much
+				score = LAST_TRIANGLE_SCORE;
+			}
+			else
+			{
+				const float scaler = 1.0f / (CACHE_SIZE - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+			}
+		}
+
+		// boost vertices with few triangles left so lone triangles are not left behind
+		score += VALENCE_BOOST_SCALE * std::pow((float)activeTriangles, -VALENCE_BOOST_POWER);
+
+		return score;
+	}
+}
+
+void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned>& indices)
+{
+	std::unordered_map<VertexKey, unsigned, VertexKeyHash> unique;
+	std::vector<unsigned> remap(vertices.size());
+	std::vector<Vertex> welded;
+
+	unique.reserve(vertices.size());
+	welded.reserve(vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const auto result = unique.emplace(VertexKey(vertices[i]), (unsigned)welded.size());
+
+		if (result.second)
+		{
+			welded.push_back(vertices[i]);
+		}
+
+		remap[i] = result.first->second;
+	}
+
+	for (auto& index : indices)
+	{
+		index = remap[index];
+	}
+
+	vertices.swap(welded);
+}
+
+void OptimizeVertexCache(std::vector<unsigned>& indices, size_t vertexCount)
+{
+	const size_t triangleCount = indices.size() / 3;
+
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// triangles adjacent to each vertex, packed into one array
+	std::vector<unsigned> activeTriangles(vertexCount, 0);
+
+	for (auto index : indices)
+	{
+		activeTriangles[index]++;
+	}
+
+	std::vector<unsigned> adjacencyOffset(vertexCount + 1, 0);
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + activeTriangles[v];
+	}
+
+	std::vector<unsigned> adjacency(indices.size());
+	std::vector<unsigned> adjacencyFill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (size_t k = 0; k < 3; k++)
+		{
+			adjacency[adjacencyFill[indices[t * 3 + k]]++] = (unsigned)t;
+		}
+	}
+
+	// initial scores
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScore[v] = VertexScore(-1, activeTriangles[v]);
+	}
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> triangleAdded(triangleCount, false);
+
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+	}
+
+	std::vector<unsigned> output;
+	output.reserve(indices.size());
+
+	std::vector<unsigned> cache;
+	std::vector<unsigned> newCache;
+	cache.reserve(CACHE_SIZE + 3);
+	newCache.reserve(CACHE_SIZE + 3);
+
+	int bestTriangle = -1;
+
+	while (output.size() < indices.size())
+	{
+		if (bestTriangle < 0)
+		{
+			// nothing in the cache touches a remaining triangle - take the best one left anywhere
+			float bestScore = -1e30f;
+
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				if (!triangleAdded[t] && triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					bestTriangle = (int)t;
+				}
+			}
+		}
+
+		const unsigned* triangle = &indices[bestTriangle * 3];
+		triangleAdded[bestTriangle] = true;
+
+		for (size_t k = 0; k < 3; k++)
+		{
+			const unsigned v = triangle[k];
+			output.push_back(v);
+
+			// remove the triangle from the active part of the vertex adjacency list
+			unsigned* begin = &adjacency[adjacencyOffset[v]];
+			unsigned* last = begin + activeTriangles[v] - 1;
+			std::iter_swap(std::find(begin, last + 1, (unsigned)bestTriangle), last);
+
+			activeTriangles[v]--;
+		}
+
+		// the emitted triangle goes to the front of the cache, the rest keep their order
+		newCache.assign(triangle, triangle + 3);
+
+		for (auto v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+			{
+				newCache.push_back(v);
+			}
+		}
+
+		// vertices that fell out of the cache
+		for (size_t i = CACHE_SIZE; i < newCache.size(); i++)
+		{
+			const unsigned v = newCache[i];
+			cachePosition[v] = -1;
+			vertexScore[v] = VertexScore(-1, activeTriangles[v]);
+
+			for (unsigned a = 0; a < activeTriangles[v]; a++)
+			{
+				const unsigned t = adjacency[adjacencyOffset[v] + a];
+				triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+			}
+		}
+
+		if (newCache.size() > CACHE_SIZE)
+		{
+			newCache.resize(CACHE_SIZE);
+		}
+
+		for (size_t i = 0; i < newCache.size(); i++)
+		{
+			cachePosition[newCache[i]] = (int)i;
+			vertexScore[newCache[i]] = VertexScore((int)i, activeTriangles[newCache[i]]);
+		}
+
+		// rescore the triangles touching the cache and pick the next one among them
+		bestTriangle = -1;
+		float bestScore = -1e30f;
+
+		for (auto v : newCache)
+		{
+			for (unsigned a = 0; a < activeTriangles[v]; a++)
+			{
+				const unsigned t = adjacency[adjacencyOffset[v] + a];
+				triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					bestTriangle = (int)t;
+				}
+			}
+		}
+
+		cache.swap(newCache);
+	}
+
+	indices.swap(output);
+}
+
+void OptimizeOverdraw(std::vector<unsigned>& indices, const std::vector<Vertex>& vertices, size_t clusterSize)
+{
+	const size_t triangleCount = indices.size() / 3;
+
+	if (triangleCount <= clusterSize || vertices.empty())
+	{
+		return;
+	}
+
+	glm::vec3 meshCentroid(0.0f);
+
+	for (const auto& vertex : vertices)
+	{
+		meshCentroid += vertex.Position;
+	}
+
+	meshCentroid /= (float)vertices.size();
+
+	struct Cluster
+	{
+		size_t first;
+		size_t count;
+		float sortKey;
+	};
+
+	std::vector<Cluster> clusters;
+
+	for (size_t first = 0; first < triangleCount; first += clusterSize)
+	{
+		Cluster cluster;
+		cluster.first = first;
+		cluster.count = std::min(clusterSize, triangleCount - first);
+
+		// area weighted centroid and normal of the cluster
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+
+		for (size_t t = first; t < first + cluster.count; t++)
+		{
+			const glm::vec3& a = vertices[indices[t * 3]].Position;
+			const glm::vec3& b = vertices[indices[t * 3 + 1]].Position;
+			const glm::vec3& c = vertices[indices[t * 3 + 2]].Position;
+
+			const glm::vec3 cross = glm::cross(b - a, c - a);
+			const float triangleArea = glm::length(cross);
+
+			centroid += (a + b + c) / 3.0f * triangleArea;
+			normal += cross;
+			area += triangleArea;
+		}
+
+		if (area > 0.0f)
+		{
+			centroid /= area;
+		}
+
+		const float normalLength = glm::length(normal);
+
+		// clusters facing away from the mesh centre are most likely to occlude the rest, so they go first
+		cluster.sortKey = normalLength > 0.0f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.0f;
+
+		clusters.push_back(cluster);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b)
+	{
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<unsigned> output;
+	output.reserve(indices.size());
+
+	for (const auto& cluster : clusters)
+	{
+		output.insert(output.end(), indices.begin() + cluster.first * 3, indices.begin() + (cluster.first + cluster.count) * 3);
+	}
+
+	indices.swap(output);
+}
+
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned>& indices)
+{
+	std::vector<unsigned> remap(vertices.size(), ~0u);
+	std::vector<Vertex> ordered;
+	ordered.reserve(vertices.size());
+
+	for (auto& index : indices)
+	{
+		if (remap[index] == ~0u)
+		{
+			remap[index] = (unsigned)ordered.size();
+			ordered.push_back(vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	vertices.swap(ordered);
+}
+
+void SimplifyVertexClustering(const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices, unsigned gridSize,
+	std::vector<Vertex>& outVertices, std::vector<unsigned>& outIndices)
+{
+	outVertices.clear();
+	outIndices.clear();
+
+	if (vertices.empty() || gridSize == 0)
+	{
+		return;
+	}
+
+	glm::vec3 boundsMin = vertices[0].Position;
+	glm::vec3 boundsMax = vertices[0].Position;
+
+	for (const auto& vertex : vertices)
+	{
+		boundsMin = glm::min(boundsMin, vertex.Position);
+		boundsMax = glm::max(boundsMax, vertex.Position);
+	}
+
+	const glm::vec3 cellScale = (float)gridSize / glm::max(boundsMax - boundsMin, glm::vec3(1e-6f));
+
+	// every vertex maps to the representative of its cell
+	std::unordered_map<unsigned, unsigned> cells;
+	std::vector<unsigned> remap(vertices.size());
+	std::vector<float> weights;
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const glm::uvec3 cell = glm::min(glm::uvec3((vertices[i].Position - boundsMin) * cellScale), glm::uvec3(gridSize - 1));
+		const unsigned key = (cell.z * gridSize + cell.y) * gridSize + cell.x;
+
+		const auto result = cells.emplace(key, (unsigned)outVertices.size());
+
+		if (result.second)
+		{
+			outVertices.push_back(Vertex());
+			outVertices.back().Position = glm::vec3(0.0f);
+			outVertices.back().Normal = glm::vec3(0.0f);
+			outVertices.back().TexCoords = glm::vec2(0.0f);
+			weights.push_back(0.0f);
+		}
+
+		const unsigned representative = result.first->second;
+		remap[i] = representative;
+
+		outVertices[representative].Position += vertices[i].Position;
+		outVertices[representative].Normal += vertices[i].Normal;
+		outVertices[representative].TexCoords += vertices[i].TexCoords;
+		weights[representative] += 1.0f;
+	}
+
+	// representatives sit at the average of the vertices they replace
+	for (size_t i = 0; i < outVertices.size(); i++)
+	{
+		outVertices[i].Position /= weights[i];
+		outVertices[i].TexCoords /= weights[i];
+
+		const float normalLength = glm::length(outVertices[i].Normal);
+		outVertices[i].Normal = normalLength > 0.0f ? outVertices[i].Normal / normalLength : glm::vec3(0.0f, 1.0f, 0.0f);
+	}
+
+	for (size_t t = 0; t + 2 < indices.size(); t += 3)
+	{
+		const unsigned a = remap[indices[t]];
+		const unsigned b = remap[indices[t + 1]];
+		const unsigned c = remap[indices[t + 2]];
+
+		// triangles with two corners in one cell collapse to nothing
+		if (a != b && b != c && a != c)
+		{
+			outIndices.push_back(a);
+			outIndices.push_back(b);
+			outIndices.push_back(c);
+		}
+	}
+
+	OptimizeVertexCache(outIndices, outVertices.size());
+	OptimizeVertexFetch(outVertices, outIndices);
+}
+
+float ComputeACMR(const std::vector<unsigned>& indices, size_t vertexCount, size_t cacheSize)
+{
+	if (indices.size() < 3)
+	{
+		return 0.0f;
+	}
+
+	// FIFO cache simulated with the time each vertex was last loaded
+	std::vector<size_t> loadedAt(vertexCount, 0);
+	size_t time = cacheSize + 1;
+	size_t misses = 0;
+
+	for (auto index : indices)
+	{
+		if (time - loadedAt[index] > cacheSize)
+		{
+			loadedAt[index] = time++;
+			misses++;
+		}
+	}
+
+	return (float)misses / (float)(indices.size() / 3);
+}
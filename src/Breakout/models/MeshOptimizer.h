@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "../Vertex.h"
+
+// Mesh optimizations used by the AssetCooker before writing a .mesh file, and by Model when building LODs
+
+// merges vertices with identical position, normal and texture coordinates and remaps the indices
+void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned>& indices);
+
+// reorders triangles for the post-transform vertex cache (Tom Forsyth's linear-speed algorithm)
+void OptimizeVertexCache(std::vector<unsigned>& indices, size_t vertexCount);
+
+// reorders groups of triangles so that outward facing clusters are drawn first, keeping the cache order inside each cluster
+void OptimizeOverdraw(std::vector<unsigned>& indices, const std::vector<Vertex>& vertices, size_t clusterSize = 64);
+
+// reorders vertices in the order they are first referenced so the vertex fetch is sequential
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned>& indices);
+
+// simplifies the mesh by merging all vertices that fall into the same cell of a gridSize^3 grid over its bounds
+// and dropping the triangles that collapse. Coarser grids give fewer triangles
+void SimplifyVertexClustering(const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices, unsigned gridSize,
+	std::vector<Vertex>& outVertices, std::vector<unsigned>& outIndices);
+
+// average cache miss ratio - transformed vertices per triangle with a FIFO cache of the given size
+float ComputeACMR(const std::vector<unsigned>& indices, size_t vertexCount, size_t cacheSize = 32);
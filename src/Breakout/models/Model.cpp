@@ -1,9 +1,67 @@
 #include "Model.h"
 
+#include <glm/glm.hpp>
+
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+
+// everything of a PackedVertex except the position, which gets a stream of its own
+struct VertexAttributes
+{
+	uint16_t TexCoords[2];
+	int16_t Normal[2];
+};
+
+const VertexBuffer* Model::instanceBuffer = nullptr;
+
+void Model::load(std::string const& path)
+{
+	//Cooked meshes are welded and cache optimized by the AssetCooker
+	const std::string binaryPath = path.substr(0, path.find_last_of('.')) + ".mesh";
+
+	if (!loadBinary(binaryPath))
+	{
+		loadASSIMP(path);
+	}
+}
+
+bool Model::loadBinary(std::string const& path)
+{
+	if (!ReadMeshFile(path, packedVertices, shortIndices, indices))
+	{
+		packedVertices.clear();
+		shortIndices.clear();
+		indices.clear();
+
+		return false;
+	}
+
+	//Full precision copy for the CPU side
+	vertices.clear();
+	vertices.reserve(packedVertices.size());
+
+	for (const auto& packed : packedVertices)
+	{
+		vertices.push_back(UnpackVertex(packed));
+	}
+
+	//32-bit copy for the CPU side as well, the 16-bit indices are the ones uploaded
+	if (!shortIndices.empty())
+	{
+		indices.assign(shortIndices.begin(), shortIndices.end());
+	}
+
+	indexType = shortIndices.empty() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+
+	computeBounds();
+
+	return true;
+}
+
 void Model::loadASSIMP(std::string const& path)
 {
 	//Creates an assimp importer
@@ -25,7 +83,7 @@ void Model::loadASSIMP(std::string const& path)
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
 		//Vertex container 
-		Vertex vertex;
+		Vertex vertex = {};
 
 		//Vertex data
 		glm::vec3 position;
@@ -81,48 +139,294 @@ void Model::loadASSIMP(std::string const& path)
 		for (unsigned int j = 0; j < face.mNumIndices; j++)
 			indices.push_back(face.mIndices[j]);
 	}
+
+	computeBounds();
+}
+
+void Model::computeBounds()
+{
+	if (vertices.empty())
+	{
+		return;
+	}
+
+	boundsMin = boundsMax = vertices[0].Position;
+
+	for (const auto& vertex : vertices)
+	{
+		boundsMin = glm::min(boundsMin, vertex.Position);
+		boundsMax = glm::max(boundsMax, vertex.Position);
+	}
+
+	//Sphere around the box centre enclosing every vertex
+	boundsCenter = (boundsMin + boundsMax) * 0.5f;
+	boundsRadius = 0.0f;
+
+	for (const auto& vertex : vertices)
+	{
+		boundsRadius = glm::max(boundsRadius, glm::length(vertex.Position - boundsCenter));
+	}
+}
+
+void Model::bakeInstances(const std::vector<glm::mat4>& transforms)
+{
+	const std::vector<Vertex> sourceVertices = std::move(vertices);
+	const std::vector<GLuint> sourceIndices = std::move(indices);
+
+	vertices.clear();
+	indices.clear();
+	vertices.reserve(sourceVertices.size() * transforms.size());
+	indices.reserve(sourceIndices.size() * transforms.size());
+
+	// setBuffers packs the baked vertices again and picks 16 bit indices when they still fit
+	packedVertices.clear();
+	shortIndices.clear();
+	indexType = GL_UNSIGNED_INT;
+
+	for (const auto& transform : transforms)
+	{
+		const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+		const auto baseVertex = (GLuint)vertices.size();
+
+		for (auto vertex : sourceVertices)
+		{
+			vertex.Position = glm::vec3(transform * glm::vec4(vertex.Position, 1.0f));
+			vertex.Normal = glm::normalize(normalMatrix * vertex.Normal);
+
+			vertices.push_back(vertex);
+		}
+
+		for (const auto index : sourceIndices)
+		{
+			indices.push_back(baseVertex + index);
+		}
+	}
+
+	computeBounds();
+}
+
+void Model::buildLods(const std::vector<unsigned>& gridSizes, const std::vector<float>& maxScreenRadii)
+{
+	lods.clear();
+	_lodVertices.clear();
+	_lodIndices.clear();
+
+	//The full mesh is level 0 and has no upper limit
+	lods.push_back({ 1e30f, 0, 0, 0, 0, 0.0f });
+
+	for (size_t i = 0; i < gridSizes.size(); i++)
+	{
+		std::vector<Vertex> lodVertices;
+		std::vector<GLuint> lodIndices;
+
+		SimplifyVertexClustering(vertices, indices, gridSizes[i], lodVertices, lodIndices);
+
+		if (lodIndices.empty())
+		{
+			break;
+		}
+
+		lods.push_back({ maxScreenRadii[i], 0, 0, 0, 0, 0.0f });
+
+		_lodVertices.push_back(std::move(lodVertices));
+		_lodIndices.push_back(std::move(lodIndices));
+	}
+}
+
+unsigned Model::selectLod(float screenRadius) const
+{
+	unsigned lod = 0;
+
+	for (unsigned i = 1; i < lods.size(); i++)
+	{
+		if (screenRadius < lods[i].maxScreenRadius)
+		{
+			lod = i;
+		}
+	}
+
+	return lod;
 }
 
 void Model::setBuffers()
 {
-	//Generate VAO
-	glGenVertexArrays(1, &VAO);
+	//Pack the vertices unless they came packed from a cooked mesh
+	if (packedVertices.size() != vertices.size())
+	{
+		packedVertices.clear();
+		packedVertices.reserve(vertices.size());
+
+		for (const auto& vertex : vertices)
+		{
+			packedVertices.push_back(PackVertex(vertex));
+		}
+	}
+
+	if (lods.empty())
+	{
+		lods.push_back({ 1e30f, 0, 0, 0, 0, 0.0f });
+	}
+
+	//Every level goes into the same buffers, each with its own first index and base vertex
+	std::vector<PackedVertex> uploadVertices = packedVertices;
+	size_t uploadIndexCount = indices.size();
+
+	lods[0].indexCount = (GLsizei)indices.size();
+	lods[0].triangleCount = (unsigned)indices.size() / 3;
+	lods[0].acmr = ComputeACMR(indices, vertices.size());
+
+	for (size_t i = 0; i < _lodVertices.size(); i++)
+	{
+		auto& lod = lods[i + 1];
+		lod.indexCount = (GLsizei)_lodIndices[i].size();
+		lod.firstIndex = uploadIndexCount;
+		lod.baseVertex = (GLint)uploadVertices.size();
+		lod.triangleCount = (unsigned)_lodIndices[i].size() / 3;
+		lod.acmr = ComputeACMR(_lodIndices[i], _lodVertices[i].size());
+
+		for (const auto& vertex : _lodVertices[i])
+		{
+			uploadVertices.push_back(PackVertex(vertex));
+		}
+
+		uploadIndexCount += _lodIndices[i].size();
+	}
+
+	//Indices are relative to the base vertex, so 16 bits are enough whenever the full mesh fits
+	if (vertices.size() <= 0xFFFF)
+	{
+		indexType = GL_UNSIGNED_SHORT;
+	}
+
+	//Positions and the other attributes go into separate streams, so the depth pre-pass fetches 12 bytes per vertex instead of 20
+	std::vector<glm::vec3> positions;
+	std::vector<VertexAttributes> attributes;
+	positions.reserve(uploadVertices.size());
+	attributes.reserve(uploadVertices.size());
+
+	for (const auto& vertex : uploadVertices)
+	{
+		positions.push_back(vertex.Position);
+		attributes.push_back({ { vertex.TexCoords[0], vertex.TexCoords[1] }, { vertex.Normal[0], vertex.Normal[1] } });
+	}
+
+	_vao = std::make_unique<VertexArray>();
+	_depthVao = std::make_unique<VertexArray>();
+
+	auto positionBuffer = std::make_unique<VertexBuffer>(&positions[0], (int)(positions.size() * sizeof(glm::vec3)));
+	auto attributeBuffer = std::make_unique<VertexBuffer>(&attributes[0], (int)(attributes.size() * sizeof(VertexAttributes)));
+
+	//Attribute locations follow projection.vert.glsl - position, texture coords, octahedral normal
+	positionBuffer->SetLayout(
+		{
+			{"inPosition", Float3}
+		}
+	);
+
+	attributeBuffer->SetLayout(
+		{
+			{"inTextureCoordinates", Half2},
+			{"inNormals", Short2Norm}
+		}
+	);
 
-	//Generate VBO and EBO buffers
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &EBO);
+	std::unique_ptr<IndexBuffer> ibo;
 
-	//Bind the VAO
-	glBindVertexArray(VAO);
+	if (indexType == GL_UNSIGNED_SHORT)
+	{
+		//16-bit indices of a cooked mesh go up as they were read, only those of OBJ meshes and generated levels are narrowed
+		std::vector<GLushort> uploadIndices = shortIndices.size() == indices.size() ? shortIndices : std::vector<GLushort>(indices.begin(), indices.end());
+		uploadIndices.reserve(uploadIndexCount);
+
+		for (const auto& lodIndices : _lodIndices)
+		{
+			uploadIndices.insert(uploadIndices.end(), lodIndices.begin(), lodIndices.end());
+		}
+
+		ibo = std::make_unique<IndexBuffer>(&uploadIndices[0], (int)uploadIndices.size());
+	}
+	else
+	{
+		std::vector<GLuint> uploadIndices = indices;
+		uploadIndices.reserve(uploadIndexCount);
 
-	//Bind the VBO buffer data
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+		for (const auto& lodIndices : _lodIndices)
+		{
+			uploadIndices.insert(uploadIndices.end(), lodIndices.begin(), lodIndices.end());
+		}
 
-	//Binf the EBO buffer data
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+		ibo = std::make_unique<IndexBuffer>(&uploadIndices[0], (int)uploadIndices.size());
+	}
 
-	//Position attribute
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+	_lodVertices.clear();
+	_lodIndices.clear();
 
-	//Texture coord attribute
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+	_depthVao->ShareVertexBuffer(*positionBuffer);
+	_depthVao->ShareIndexBuffer(*ibo);
 
-	//Normals attribute
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+	_vao->SetVertexBuffer(std::move(positionBuffer));
+	_vao->SetVertexBuffer(std::move(attributeBuffer));
+	_vao->SetIndexBuffer(std::move(ibo));
 
-	//Unbind the VAO
-	glBindVertexArray(0);
+	// model matrix and colour follow the vertex attributes, advancing once per instance
+	if (instanceBuffer)
+	{
+		_vao->ShareVertexBuffer(*instanceBuffer, 1);
+		_depthVao->ShareVertexBuffer(*instanceBuffer, 1);
+	}
 }
 
-void Model::render()
+void Model::takeMesh(Model&& loaded)
 {
-	//Bind the VAO and draw elements - unbind when complete
-	glBindVertexArray(VAO);
-	glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-}
\ No newline at end of file
+	vertices = std::move(loaded.vertices);
+	indices = std::move(loaded.indices);
+	packedVertices = std::move(loaded.packedVertices);
+	shortIndices = std::move(loaded.shortIndices);
+	lods = std::move(loaded.lods);
+	indexType = loaded.indexType;
+
+	boundsMin = loaded.boundsMin;
+	boundsMax = loaded.boundsMax;
+	boundsCenter = loaded.boundsCenter;
+	boundsRadius = loaded.boundsRadius;
+
+	_lodVertices = std::move(loaded._lodVertices);
+	_lodIndices = std::move(loaded._lodIndices);
+}
+
+void Model::render(unsigned lod, unsigned instance)
+{
+	// still loading
+	if (!_vao)
+	{
+		return;
+	}
+
+	draw(*_vao, lod, instance);
+}
+
+void Model::renderDepth(unsigned lod, unsigned instance)
+{
+	if (!_depthVao)
+	{
+		return;
+	}
+
+	draw(*_depthVao, lod, instance);
+}
+
+void Model::draw(const VertexArray& vao, unsigned lod, unsigned instance) const
+{
+	if (lod >= lods.size())
+	{
+		return;
+	}
+
+	const auto& level = lods[lod];
+	const size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+
+	// the VAO stays bound, the next draw of this model skips the bind
+	vao.Bind();
+	// a single instance, the base instance selects its entry of the instance buffer
+	glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, level.indexCount, indexType, (void*)(level.firstIndex * indexSize), 1, level.baseVertex, instance);
+}
@@ -1,27 +1,110 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <glad/glad.h>
 
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
 #include "../Vertex.h"
+#include "../VertexArray.h"
+
+// One entry of a model's level of detail chain - all levels share the model's vertex and index buffers
+struct ModelLod
+{
+	// used while the projected radius of the model is below this many pixels
+	float maxScreenRadius;
+
+	GLsizei indexCount;
+	size_t firstIndex;
+	GLint baseVertex;
+
+	unsigned triangleCount;
+	// transformed vertices per triangle, see ComputeACMR
+	float acmr;
+};
+
+// One draw item in the instance buffer every model reads from, see Model::instanceBuffer
+struct ModelInstance
+{
+	// rows of the affine model matrix, the fourth is always 0 0 0 1
+	glm::vec4 rows[3];
+	glm::vec4 colour;
+
+	// rows of the normal matrix in xyz, computed once per object by ComposeTransforms. w is unused
+	glm::vec4 normalRows[3];
+};
 
 class Model
 {
 public:
+	// per instance stream of ModelInstances shared by every model, attached by setBuffers. Set it before any model loads
+	static const VertexBuffer* instanceBuffer;
+
+	// loads the cooked .mesh next to the given model if there is one, the model itself otherwise
+	void load(std::string const& path);
+
 	void loadASSIMP(std::string const& path);
 
-	void render();
+	bool loadBinary(std::string const& path);
+
+	// draws one instance, reading entry instance of instanceBuffer
+	void render(unsigned lod = 0, unsigned instance = 0);
+
+	// positions only, for the depth pre-pass (res/depth.*.glsl)
+	void renderDepth(unsigned lod = 0, unsigned instance = 0);
 
 	void setBuffers();
 
+	// moves the mesh, bounds and levels of detail of loaded into this model, ready for setBuffers. Lets the loader
+	// decode into a model of its own on a worker, so the GL thread never reads one that is half written
+	void takeMesh(Model&& loaded);
+
+	// simplifies the loaded mesh once per grid size (coarsest last) before setBuffers uploads everything.
+	// Level i + 1 is drawn while the projected radius is below maxScreenRadii[i] pixels
+	void buildLods(const std::vector<unsigned>& gridSizes, const std::vector<float>& maxScreenRadii);
+
+	// picks the coarsest level allowed for a model covering screenRadius pixels
+	unsigned selectLod(float screenRadius) const;
+
+	// local space bounds, computed from the vertices after loading
+	void computeBounds();
+
+	// replaces the loaded mesh by one copy of it per transform, moved into place, so static geometry
+	// made of many copies is drawn with one call. Run it before buildLods and setBuffers
+	void bakeInstances(const std::vector<glm::mat4>& transforms);
+
 	std::vector<Vertex> vertices;
 	std::vector<GLuint> indices;
 
+	// compact copy of the vertices that is uploaded, read straight from cooked meshes
+	std::vector<PackedVertex> packedVertices;
+
+	// the indices of a cooked mesh stored with 16 bits, uploaded as they are. Empty for 32-bit and OBJ meshes
+	std::vector<GLushort> shortIndices;
+
+	// level 0 is the full mesh, filled in by setBuffers
+	std::vector<ModelLod> lods;
+
+	// GL_UNSIGNED_SHORT when the cooked mesh stores 16-bit indices
+	GLenum indexType = GL_UNSIGNED_INT;
+
+	glm::vec3 boundsMin = glm::vec3(0.0f);
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+	glm::vec3 boundsCenter = glm::vec3(0.0f);
+	float boundsRadius = 0.0f;
+
 private:
-	GLuint VBO;
+	void draw(const VertexArray& vao, unsigned lod, unsigned instance) const;
+
+	std::unique_ptr<VertexArray> _vao;
 
-	GLuint VAO;
+	// reads only the position stream and the index buffer of _vao
+	std::unique_ptr<VertexArray> _depthVao;
 
-	GLuint EBO;
+	// simplified levels waiting for setBuffers
+	std::vector<std::vector<Vertex>> _lodVertices;
+	std::vector<std::vector<GLuint>> _lodIndices;
 };
\ No newline at end of file
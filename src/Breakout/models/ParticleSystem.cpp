@@ -0,0 +1,114 @@
+#include "ParticleSystem.h"
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+ParticleSystem::ParticleSystem(unsigned particlesPerBurst)
+	: _particlesPerBurst(particlesPerBurst)
+{
+	const GLfloat corners[8] =
+	{
+		-1.0f, -1.0f,
+		 1.0f, -1.0f,
+		 1.0f,  1.0f,
+		-1.0f,  1.0f
+	};
+
+	const GLuint indices[6] =
+	{
+		0, 1, 2,
+		2, 3, 0
+	};
+
+	_vao = std::make_unique<VertexArray>();
+
+	auto quad = std::make_unique<VertexBuffer>(corners, (int)sizeof(corners));
+	quad->SetLayout({ {"inCorner", Float2} });
+
+	_vao->SetVertexBuffer(std::move(quad));
+	_vao->SetIndexBuffer(std::make_unique<IndexBuffer>(indices, 6));
+
+	// everything is allocated once, the particles never leave the GPU
+	for (auto& particles : _particles)
+	{
+		particles = std::make_unique<ShaderStorageBuffer>(nullptr, (int)(MAX_PARTICLES * sizeof(Particle)));
+	}
+
+	const DrawCommand commands[2] =
+	{
+		{ 6, 0, 0, 0, 0 },
+		{ 6, 0, 0, 0, 0 }
+	};
+
+	_commands = std::make_unique<ShaderStorageBuffer>(commands, (int)sizeof(commands));
+	_burstBuffer = std::make_unique<ShaderStorageBuffer>(nullptr, (int)(MAX_BURSTS * 2 * sizeof(glm::vec4)), GL_DYNAMIC_STORAGE_BIT);
+
+	_bursts.reserve(MAX_BURSTS * 2);
+}
+
+void ParticleSystem::Burst(glm::vec3 position, glm::vec3 colour)
+{
+	if (_bursts.size() < MAX_BURSTS * 2)
+	{
+		_bursts.push_back(glm::vec4(position, 1.0f));
+		_bursts.push_back(glm::vec4(colour, 1.0f));
+	}
+}
+
+void ParticleSystem::Update(Shader& updateShader, Shader& emitShader, float dt)
+{
+	const unsigned next = 1 - _current;
+
+	// the instance count of the next buffer's draw is also its particle counter
+	_commands->Clear(sizeof(GLuint), (int)(next * sizeof(DrawCommand) + offsetof(DrawCommand, instanceCount)));
+
+	_particles[_current]->BindBase(2);
+	_particles[next]->BindBase(3);
+	_commands->BindBase(4);
+
+	// the live count is only known on the GPU, so every slot gets an invocation and the ones past the count return
+	updateShader.use();
+	updateShader.setFloat("uDeltaTime", dt);
+	updateShader.setInt("uSource", (int)_current);
+	updateShader.setInt("uTarget", (int)next);
+
+	glDispatchCompute(MAX_PARTICLES / 64, 1, 1);
+
+	if (!_bursts.empty())
+	{
+		const unsigned burstCount = (unsigned)_bursts.size() / 2;
+
+		_burstBuffer->SetData(_bursts.data(), (int)(_bursts.size() * sizeof(glm::vec4)));
+		_burstBuffer->BindBase(5);
+
+		// the emitted particles count on from the survivors
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		emitShader.use();
+		emitShader.setInt("uTarget", (int)next);
+		emitShader.setInt("uBurstCount", (int)burstCount);
+		emitShader.setInt("uParticlesPerBurst", (int)_particlesPerBurst);
+		emitShader.setInt("uSeed", (int)_seed);
+
+		glDispatchCompute((burstCount * _particlesPerBurst + 63) / 64, 1, 1);
+
+		_bursts.clear();
+	}
+
+	_seed++;
+	_current = next;
+
+	// the draw reads the particles in the vertex shader and its instance count from the command
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
+
+void ParticleSystem::Render()
+{
+	_particles[_current]->BindBase(2);
+
+	_vao->Bind();
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commands->GetID());
+	glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)(_current * sizeof(DrawCommand)));
+}
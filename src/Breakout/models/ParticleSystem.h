@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "../Shader.h"
+#include "../VertexArray.h"
+#include "../buffers/ShaderStorageBuffer.h"
+
+// Sparks that live entirely on the GPU. Bursts are queued on the CPU, then compute shaders spawn
+// their particles (res/particleEmit.comp.glsl), move them and copy the survivors into the other
+// of two fixed storage buffers (res/particleUpdate.comp.glsl). The survivor count is the instance
+// count of an indirect draw, so every particle is a camera facing quad (res/particle.*.glsl)
+// without the CPU ever reading how many there are
+class ParticleSystem
+{
+public:
+	// memory budget - particles spawned past it are dropped
+	static const unsigned MAX_PARTICLES = 65536;
+
+	// bursts queued between two Updates, later ones wait for the next Update
+	static const unsigned MAX_BURSTS = 64;
+
+	explicit ParticleSystem(unsigned particlesPerBurst);
+
+	// particles fly out of position in about this colour on the next Update
+	void Burst(glm::vec3 position, glm::vec3 colour);
+
+	// moves the particles dt seconds, drops the dead ones and spawns the queued bursts
+	void Update(Shader& updateShader, Shader& emitShader, float dt);
+
+	// draws every live particle with one indirect instanced call, the particle shader has to be in use
+	void Render();
+
+private:
+	// std430 layout of the particle buffers, only the size is used on the CPU
+	struct Particle
+	{
+		glm::vec3 position;
+		float life;
+		glm::vec3 velocity;
+		float lifetime;
+		glm::vec4 colour;
+	};
+
+	// glDrawElementsIndirect arguments, one per particle buffer
+	struct DrawCommand
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLuint baseVertex;
+		GLuint baseInstance;
+	};
+
+	unsigned _particlesPerBurst;
+
+	// xyz position and colour of the queued bursts
+	std::vector<glm::vec4> _bursts;
+
+	std::unique_ptr<ShaderStorageBuffer> _particles[2];
+	std::unique_ptr<ShaderStorageBuffer> _commands;
+	std::unique_ptr<ShaderStorageBuffer> _burstBuffer;
+
+	std::unique_ptr<VertexArray> _vao;
+
+	// the buffer holding the live particles, Update writes the other one
+	unsigned _current = 0;
+
+	// changes every Update so no two bursts look the same
+	unsigned _seed = 0;
+};
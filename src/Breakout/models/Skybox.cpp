@@ -0,0 +1,57 @@
+#include "Skybox.h"
+
+#include <glad/glad.h>
+
+Skybox::Skybox()
+{
+	colour = { 1.0f, 1.0f, 1.0f };
+	rotation = 90.0f;
+}
+
+void Skybox::SetBuffers()
+{
+	// the corners double as the cube map directions
+	GLfloat vertices[24] =
+	{
+		-1.0f, -1.0f, -1.0f,
+		 1.0f, -1.0f, -1.0f,
+		 1.0f,  1.0f, -1.0f,
+		-1.0f,  1.0f, -1.0f,
+		-1.0f, -1.0f,  1.0f,
+		 1.0f, -1.0f,  1.0f,
+		 1.0f,  1.0f,  1.0f,
+		-1.0f,  1.0f,  1.0f
+	};
+
+	// counter-clockwise seen from inside the cube
+	GLuint indices[36] =
+	{
+		0, 1, 2,	0, 2, 3,	// -z
+		4, 6, 5,	4, 7, 6,	// +z
+		0, 7, 4,	0, 3, 7,	// -x
+		1, 6, 2,	1, 5, 6,	// +x
+		0, 5, 1,	0, 4, 5,	// -y
+		3, 6, 7,	3, 2, 6		// +y
+	};
+
+	_vao = std::make_unique<VertexArray>();
+
+	auto vbo = std::make_unique<VertexBuffer>(vertices, (int)sizeof(vertices));
+
+	vbo->SetLayout(
+		{
+			{"Position", Float3}
+		}
+	);
+
+	auto ibo = std::make_unique<IndexBuffer>(indices, 36);
+
+	_vao->SetVertexBuffer(std::move(vbo));
+	_vao->SetIndexBuffer(std::move(ibo));
+}
+
+void Skybox::Render() const
+{
+	_vao->Bind();
+	glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
+}
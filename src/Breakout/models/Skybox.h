@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+
+#include <glm/vec3.hpp>
+
+#include "../Texture.h"
+#include "../VertexArray.h"
+
+// The background: a cube map sampled by view direction on a unit cube around the camera (res/skybox.*.glsl).
+// Drawn after the scene at maximum depth, so early-z rejects it wherever anything else was drawn
+class Skybox
+{
+public:
+	Skybox();
+
+	void SetBuffers();
+
+	void Render() const;
+
+	// tints the cube map, the sky is not lit
+	glm::vec3 colour;
+
+	// about the y axis, in radians
+	float rotation;
+
+	Texture texture;
+
+private:
+	std::unique_ptr<VertexArray> _vao;
+};
@@ -4,32 +4,25 @@ Square::Square() {}
 
 void Square::SetBuffers()
 {
-	glGenBuffers(1, &VBO);
+	_vao = std::make_unique<VertexArray>();
 
-	glGenVertexArrays(1, &VAO);
+	auto vbo = std::make_unique<VertexBuffer>(vertices, (int)sizeof(vertices));
 
-	glGenBuffers(1, &EBO);
+	vbo->SetLayout(
+		{
+			{"Position", Float3},
+			{"texCoord", Float2}
+		}
+	);
 
-	glBindVertexArray(VAO);
+	auto ibo = std::make_unique<IndexBuffer>(indices, 6);
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
-
-	glBindVertexArray(0);
+	_vao->SetVertexBuffer(std::move(vbo));
+	_vao->SetIndexBuffer(std::move(ibo));
 }
 
 void Square::Render() const
 {
-	glBindVertexArray(VAO);
+	_vao->Bind();
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
-	glBindVertexArray(0);
 }
\ No newline at end of file
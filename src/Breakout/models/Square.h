@@ -1,7 +1,11 @@
 #pragma once
 
+#include <memory>
+
 #include <glad/glad.h>
 
+#include "../VertexArray.h"
+
 class Square
 {
 public:
@@ -26,9 +30,6 @@ public:
 		1, 2, 3
 	};
 
-	GLuint VBO;
-
-	GLuint VAO;
-
-	GLuint EBO;
+private:
+	std::unique_ptr<VertexArray> _vao;
 };
@@ -0,0 +1,53 @@
+#version 450 core
+out vec4 colourFragment;
+
+in vec3 viewPosition;
+in vec3 sphereCenter;
+in float sphereRadius;
+
+uniform mat4 uProjection;
+uniform mat4 uInverseView;
+uniform vec3 uLightPosition;
+uniform vec3 uLightColour;
+uniform vec3 uObjectColour;
+uniform sampler2D uTexture;
+
+const float PI = 3.14159265;
+
+void main()
+{
+	// ray from the eye through this fragment against the sphere
+	vec3 rayDirection = normalize(viewPosition);
+	float b = dot(rayDirection, sphereCenter);
+	float c = dot(sphereCenter, sphereCenter) - sphereRadius * sphereRadius;
+	float discriminant = b * b - c;
+
+	if (discriminant < 0.0)
+	{
+		discard;
+	}
+
+	vec3 hit = rayDirection * (b - sqrt(discriminant));
+
+	// depth of the real surface so impostors intersect the rest of the scene correctly
+	vec4 clipPosition = uProjection * vec4(hit, 1.0);
+	gl_FragDepth = (clipPosition.z / clipPosition.w) * 0.5 + 0.5;
+
+	vec3 fragmentPosition = vec3(uInverseView * vec4(hit, 1.0));
+	vec3 normal = normalize(mat3(uInverseView) * (hit - sphereCenter));
+
+	// spherical mapping in place of the mesh's texture coordinates
+	vec2 textureCoordinates = vec2(0.5 + atan(normal.z, normal.x) / (2.0 * PI), 0.5 - asin(normal.y) / PI);
+
+	// same lighting as projection.frag.glsl
+	float ambientCoefficient = 0.4f;
+	vec3 ambient = ambientCoefficient * uLightColour;
+
+	float diffuseCoefficient = 0.8f;
+	vec3 lightDirection = normalize(uLightPosition - fragmentPosition);
+	float diffuseMax = max(dot(normal, lightDirection), 0.0);
+	vec3 diffuse = diffuseCoefficient * diffuseMax * uLightColour;
+
+	vec3 ambientDiffuseSpecular = (ambient + diffuse) * uObjectColour;
+	colourFragment = vec4(ambientDiffuseSpecular, 1.0) * texture(uTexture, textureCoordinates);
+}
@@ -0,0 +1,26 @@
+#version 450 core
+
+layout (location = 0) in vec2 inCorner;	// quad corner in [-1, 1]
+layout (location = 1) in vec4 inSphere;	// per instance - world space center and radius
+
+out vec3 viewPosition;		// point on the quad in view space, the ray direction for the fragment
+out vec3 sphereCenter;		// view space
+out float sphereRadius;
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+
+void main()
+{
+	sphereCenter = vec3(uView * vec4(inSphere.xyz, 1.0));
+	sphereRadius = inSphere.w;
+
+	// under perspective the silhouette is wider than the radius - grow the quad so it
+	// still covers the whole sphere when placed at the center's depth
+	float distance = max(length(sphereCenter), sphereRadius * 1.001);
+	float halfSize = sphereRadius * distance / sqrt(distance * distance - sphereRadius * sphereRadius);
+
+	viewPosition = sphereCenter + vec3(inCorner * halfSize, 0.0);
+
+	gl_Position = uProjection * vec4(viewPosition, 1.0);
+}
@@ -0,0 +1,6 @@
+#version 450 core
+
+// colour writes are off during the pre-pass, only the depth the rasterizer produces is kept
+void main()
+{
+}
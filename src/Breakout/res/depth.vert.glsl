@@ -0,0 +1,21 @@
+#version 450 core
+
+layout (location = 0) in vec3 inPosition;	// the position stream alone, see Model::renderDepth
+layout (location = 1) in vec4 inModelRow0;	// per instance - rows of the model matrix, see ModelInstance
+layout (location = 2) in vec4 inModelRow1;
+layout (location = 3) in vec4 inModelRow2;
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+
+// same expression as projection.vert.glsl, so the lit pass can test GL_LEQUAL against this depth
+invariant gl_Position;
+
+void main()
+{
+	vec4 position = vec4(inPosition, 1.0f);
+
+	vec3 worldPosition = vec3(dot(inModelRow0, position), dot(inModelRow1, position), dot(inModelRow2, position));
+
+	gl_Position = uProjection * uView * vec4(worldPosition, 1.0f);
+}
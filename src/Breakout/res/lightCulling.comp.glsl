@@ -0,0 +1,106 @@
+#version 450 core
+
+// one invocation per light, each one adds itself to every tile its bounds cover. Gathering per
+// tile instead would test every light against every tile, which software rasterizers cannot keep up with
+layout (local_size_x = 64) in;
+
+// TiledLighting::TILE_SIZE and MAX_LIGHTS_PER_TILE
+const uint TILE_SIZE = 16;
+const uint MAX_LIGHTS_PER_TILE = 256;
+
+struct PointLight
+{
+	vec3 position;
+	float radius;
+	vec3 colour;
+	float intensity;
+};
+
+layout (std430, binding = 0) readonly buffer Lights
+{
+	PointLight lights[];
+};
+
+// the light count of every tile first, cleared before the dispatch, then MAX_LIGHTS_PER_TILE indices per tile
+layout (std430, binding = 1) buffer TileLights
+{
+	uint tileLights[];
+};
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+uniform int uTilesX;
+uniform int uTilesY;
+uniform vec2 uViewportSize;
+uniform int uLightCount;
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	if (index >= uint(uLightCount))
+	{
+		return;
+	}
+
+	ivec2 tiles = ivec2(uTilesX, uTilesY);
+
+	vec3 centre = vec3(uView * vec4(lights[index].position, 1.0));
+	float radius = lights[index].radius;
+
+	// entirely behind the eye
+	if (centre.z - radius > 0.0)
+	{
+		return;
+	}
+
+	ivec2 tileMin = ivec2(0);
+	ivec2 tileMax = tiles - 1;
+
+	// the screen rectangle of the view space box around the sphere. A sphere reaching
+	// behind the near plane does not project to a rectangle, it gets every tile instead
+	float near = uProjection[3][2] / (uProjection[2][2] - 1.0);
+
+	if (centre.z + radius < -near)
+	{
+		vec2 ndcMin = vec2(1.0);
+		vec2 ndcMax = vec2(-1.0);
+
+		for (int corner = 0; corner < 8; corner++)
+		{
+			vec3 offset = vec3((corner & 1) != 0 ? radius : -radius, (corner & 2) != 0 ? radius : -radius, (corner & 4) != 0 ? radius : -radius);
+			vec4 clip = uProjection * vec4(centre + offset, 1.0);
+
+			ndcMin = min(ndcMin, clip.xy / clip.w);
+			ndcMax = max(ndcMax, clip.xy / clip.w);
+		}
+
+		// off screen
+		if (any(lessThan(ndcMax, vec2(-1.0))) || any(greaterThan(ndcMin, vec2(1.0))))
+		{
+			return;
+		}
+
+		vec2 pixelMin = (clamp(ndcMin, -1.0, 1.0) * 0.5 + 0.5) * uViewportSize;
+		vec2 pixelMax = (clamp(ndcMax, -1.0, 1.0) * 0.5 + 0.5) * uViewportSize;
+
+		tileMin = clamp(ivec2(pixelMin) / int(TILE_SIZE), ivec2(0), tiles - 1);
+		tileMax = clamp(ivec2(pixelMax) / int(TILE_SIZE), ivec2(0), tiles - 1);
+	}
+
+	uint tileCount = uint(tiles.x * tiles.y);
+
+	for (int y = tileMin.y; y <= tileMax.y; y++)
+	{
+		for (int x = tileMin.x; x <= tileMax.x; x++)
+		{
+			uint tile = uint(y * tiles.x + x);
+			uint slot = atomicAdd(tileLights[tile], 1);
+
+			if (slot < MAX_LIGHTS_PER_TILE)
+			{
+				tileLights[tileCount + tile * MAX_LIGHTS_PER_TILE + slot] = index;
+			}
+		}
+	}
+}
@@ -1,4 +1,4 @@
-#version 460 core
+#version 450 core
 
 struct Material {
     sampler2D texture_diffuse1;
@@ -0,0 +1,18 @@
+#version 450 core
+out vec4 colourFragment;
+
+in vec2 corner;
+in vec4 colour;
+
+void main()
+{
+	// round spark, brightest in the middle
+	float falloff = 1.0 - dot(corner, corner);
+
+	if (falloff <= 0.0)
+	{
+		discard;
+	}
+
+	colourFragment = vec4(colour.rgb, colour.a * falloff * falloff);
+}
@@ -0,0 +1,41 @@
+#version 450 core
+
+layout (location = 0) in vec2 inCorner;	// quad corner in [-1, 1]
+
+// ParticleSystem::Particle, one per instance
+struct Particle
+{
+	vec3 position;
+	float life;
+	vec3 velocity;
+	float lifetime;
+	vec4 colour;
+};
+
+layout (std430, binding = 2) readonly buffer Particles
+{
+	Particle particles[];
+};
+
+out vec2 corner;
+out vec4 colour;
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+
+void main()
+{
+	Particle particle = particles[gl_InstanceID];
+
+	// shrinks and fades over its life
+	float age = particle.life / particle.lifetime;
+	float halfSize = 0.06 * (0.5 + 0.5 * age);
+
+	vec4 viewPosition = uView * vec4(particle.position, 1.0);
+	viewPosition.xy += inCorner * halfSize;
+
+	corner = inCorner;
+	colour = vec4(particle.colour.rgb, age);
+
+	gl_Position = uProjection * viewPosition;
+}
@@ -0,0 +1,88 @@
+#version 450 core
+
+layout (local_size_x = 64) in;
+
+// ParticleSystem::MAX_PARTICLES
+const uint MAX_PARTICLES = 65536;
+
+// ParticleSystem::Particle
+struct Particle
+{
+	vec3 position;
+	float life;
+	vec3 velocity;
+	float lifetime;
+	vec4 colour;
+};
+
+layout (std430, binding = 3) writeonly buffer TargetParticles
+{
+	Particle target[];
+};
+
+layout (std430, binding = 4) buffer Commands
+{
+	uint commands[10];
+};
+
+// position and colour of every burst
+layout (std430, binding = 5) readonly buffer Bursts
+{
+	vec4 bursts[];
+};
+
+uniform int uTarget;
+uniform int uBurstCount;
+uniform int uParticlesPerBurst;
+uniform int uSeed;
+
+// PCG hash, a different number for every invocation and frame
+uint Hash(uint value)
+{
+	uint state = value * 747796405u + 2891336453u;
+	uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+float Random(inout uint state)
+{
+	state = Hash(state);
+	return float(state) / 4294967295.0;
+}
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	if (index >= uint(uBurstCount * uParticlesPerBurst))
+	{
+		return;
+	}
+
+	uint slot = atomicAdd(commands[uTarget * 5 + 1], 1);
+
+	// out of budget - give the slot back, the count ends up at exactly MAX_PARTICLES
+	if (slot >= MAX_PARTICLES)
+	{
+		atomicAdd(commands[uTarget * 5 + 1], uint(-1));
+		return;
+	}
+
+	uint burst = index / uint(uParticlesPerBurst);
+	uint state = Hash(index ^ Hash(uint(uSeed)));
+
+	// a direction on the unit sphere, thrown mostly upwards and towards the camera
+	float z = Random(state) * 2.0 - 1.0;
+	float angle = Random(state) * 6.2831853;
+	vec3 direction = vec3(sqrt(1.0 - z * z) * vec2(cos(angle), sin(angle)), z);
+	direction.yz = abs(direction.yz) * vec2(1.5, 1.0);
+
+	Particle particle;
+	particle.position = bursts[burst * 2].xyz + (vec3(Random(state), Random(state), Random(state)) - 0.5) * 0.8;
+	particle.velocity = direction * mix(2.0, 9.0, Random(state));
+	particle.lifetime = mix(0.5, 1.5, Random(state));
+	particle.life = particle.lifetime;
+	particle.colour = vec4(bursts[burst * 2 + 1].rgb * mix(0.8, 1.6, Random(state)), 1.0);
+
+	target[slot] = particle;
+}
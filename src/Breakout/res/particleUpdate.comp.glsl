@@ -0,0 +1,61 @@
+#version 450 core
+
+layout (local_size_x = 64) in;
+
+// ParticleSystem::Particle
+struct Particle
+{
+	vec3 position;
+	float life;
+	vec3 velocity;
+	float lifetime;
+	vec4 colour;
+};
+
+layout (std430, binding = 2) readonly buffer SourceParticles
+{
+	Particle source[];
+};
+
+layout (std430, binding = 3) writeonly buffer TargetParticles
+{
+	Particle target[];
+};
+
+// ParticleSystem::DrawCommand for each buffer, the instance count is the particle count
+layout (std430, binding = 4) buffer Commands
+{
+	uint commands[10];
+};
+
+uniform float uDeltaTime;
+uniform int uSource;
+uniform int uTarget;
+
+const vec3 gravity = vec3(0.0, -9.8, 0.0);
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	if (index >= commands[uSource * 5 + 1])
+	{
+		return;
+	}
+
+	Particle particle = source[index];
+
+	particle.life -= uDeltaTime;
+
+	if (particle.life <= 0.0)
+	{
+		return;
+	}
+
+	// a little air drag so the bursts settle instead of flying off the screen
+	particle.velocity = (particle.velocity + gravity * uDeltaTime) * (1.0 - 1.5 * uDeltaTime);
+	particle.position += particle.velocity * uDeltaTime;
+
+	// survivors are packed at the front of the other buffer
+	target[atomicAdd(commands[uTarget * 5 + 1], 1)] = particle;
+}
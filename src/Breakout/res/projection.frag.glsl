@@ -1,16 +1,71 @@
-#version 460 core
+#version 450 core
 out vec4 colourFragment;
 
 in vec2 textureCoordinates;
 in vec3 transposedNormals;
 in vec3 fragmentPosition;
 in vec3 lightColour;
+in vec3 objectColour;
 
 uniform vec3 uLightPosition; 
 uniform vec3 uViewPosition; 
-uniform vec3 uObjectColour;
 uniform sampler2D uTexture;
 
+// point lights culled into screen tiles by lightCulling.comp.glsl
+const uint TILE_SIZE = 16;
+const uint MAX_LIGHTS_PER_TILE = 256;
+
+struct PointLight
+{
+	vec3 position;
+	float radius;
+	vec3 colour;
+	float intensity;
+};
+
+layout (std430, binding = 0) readonly buffer Lights
+{
+	PointLight lights[];
+};
+
+// the light count of every tile, then MAX_LIGHTS_PER_TILE light indices per tile
+layout (std430, binding = 1) readonly buffer TileLights
+{
+	uint tileLights[];
+};
+
+uniform int uTilesX;
+uniform int uTilesY;
+
+// diffuse light of the point lights listed for this pixel's tile
+vec3 TileLighting(vec3 normal)
+{
+	uvec2 tile = min(uvec2(gl_FragCoord.xy) / TILE_SIZE, uvec2(uTilesX, uTilesY) - 1u);
+	uint index = tile.y * uint(uTilesX) + tile.x;
+	uint base = uint(uTilesX * uTilesY) + index * MAX_LIGHTS_PER_TILE;
+
+	// the culling pass keeps counting past a full tile
+	uint count = min(tileLights[index], MAX_LIGHTS_PER_TILE);
+
+	vec3 result = vec3(0.0);
+
+	for (uint i = 0; i < count; i++)
+	{
+		PointLight light = lights[tileLights[base + i]];
+
+		vec3 toLight = light.position - fragmentPosition;
+		float distance = length(toLight);
+
+		// inverse square, windowed so it reaches zero at the radius the tiles were culled with
+		float window = clamp(1.0 - pow(distance / light.radius, 4.0), 0.0, 1.0);
+		float attenuation = window * window / (distance * distance + 1.0);
+
+		result += max(dot(normal, toLight / max(distance, 1e-4)), 0.0) * attenuation * light.intensity * light.colour;
+	}
+
+	return result;
+}
+
 void main()
 {
     // ambient light component
@@ -25,6 +80,6 @@ void main()
     vec3 diffuse = diffuseCoefficient * diffuseMax * lightColour;
 
 	// resultant output fragment colour
-	vec3 ambientDiffuseSpecular = (ambient + diffuse) * uObjectColour;
+	vec3 ambientDiffuseSpecular = (ambient + diffuse + TileLighting(normalizedNormal)) * objectColour;
     colourFragment =  vec4(ambientDiffuseSpecular, 1.0) * texture(uTexture, textureCoordinates);
 } 
\ No newline at end of file
@@ -1,28 +1,53 @@
-#version 460 core
+#version 450 core
 
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec2 inTextureCoordinates;
-layout (location = 2) in vec3 inNormals;
+layout (location = 2) in vec2 inNormals;	// octahedral encoded
+layout (location = 3) in vec4 inModelRow0;	// per instance - rows of the model matrix, see ModelInstance
+layout (location = 4) in vec4 inModelRow1;
+layout (location = 5) in vec4 inModelRow2;
+layout (location = 6) in vec4 inColour;
+layout (location = 7) in vec4 inNormalRow0;	// per instance - rows of the normal matrix, computed once per object on the CPU
+layout (location = 8) in vec4 inNormalRow1;
+layout (location = 9) in vec4 inNormalRow2;
 
 out vec2 textureCoordinates;
 out vec3 transposedNormals;
 out vec3 fragmentPosition;
 out vec3 lightColour;
+out vec3 objectColour;
 
-uniform mat4 uModel;
 uniform mat4 uView;
 uniform mat4 uProjection;
 uniform vec3 uLightColour;
 
+// the depth pre-pass (depth.vert.glsl) computes the same position, both have to land on exactly the same depth
+invariant gl_Position;
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0);
+	normal.x += normal.x >= 0.0 ? -fold : fold;
+	normal.y += normal.y >= 0.0 ? -fold : fold;
+	return normalize(normal);
+}
+
 void main()
 {   
-	gl_Position = uProjection * uView * uModel * vec4(inPosition, 1.0f);
-	
-	fragmentPosition = vec3(uModel * vec4(inPosition, 1.0f));
+	vec3 normal = DecodeOctahedral(inNormals);
+
+	vec4 position = vec4(inPosition, 1.0f);
+
+	fragmentPosition = vec3(dot(inModelRow0, position), dot(inModelRow1, position), dot(inModelRow2, position));
+
+	gl_Position = uProjection * uView * vec4(fragmentPosition, 1.0f);
 	
-	transposedNormals = mat3(transpose(inverse(uModel))) * inNormals;  
+	// the fragment shader normalizes, so the normal matrix only has to be right up to a positive factor
+	transposedNormals = vec3(dot(inNormalRow0.xyz, normal), dot(inNormalRow1.xyz, normal), dot(inNormalRow2.xyz, normal));
 	
 	textureCoordinates = inTextureCoordinates;
 	
 	lightColour = uLightColour;
+	objectColour = inColour.rgb;
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 450 core
+
+in vec3 skyDirection;
+out vec4 colourFragment;
+
+uniform samplerCube uSkybox;
+uniform vec3 uColour;
+
+void main()
+{
+	colourFragment = vec4(uColour, 1.0) * texture(uSkybox, skyDirection);
+}
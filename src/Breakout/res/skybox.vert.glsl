@@ -0,0 +1,19 @@
+#version 450 core
+
+layout (location = 0) in vec3 inPosition;	// corner of a unit cube, also the direction to sample
+
+out vec3 skyDirection;
+
+uniform mat4 uView;			// rotation only - the sky stays around the camera wherever it moves
+uniform mat4 uProjection;
+uniform mat4 uModel;		// spins the sky about the y axis
+
+void main()
+{
+	skyDirection = inPosition;
+
+	vec4 position = uProjection * uView * uModel * vec4(inPosition, 1.0);
+
+	// z = w lands on the far plane after the divide, so with GL_LEQUAL the sky only fills what the scene left empty
+	gl_Position = position.xyww;
+}
@@ -1,4 +1,4 @@
-#version 460 core
+#version 450 core
 
 in vec2 textureCoordinate;	//Texture coords from vertex shader
 out vec4 fragmentColour;	//Output colour of vertex
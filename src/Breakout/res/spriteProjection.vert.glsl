@@ -1,4 +1,4 @@
-#version 460 core
+#version 450 core
 
 layout (location = 0) in vec3 Position; //vertex positions
 layout (location = 1) in vec2 texCoord;	//texture coordinates